@@ -0,0 +1,64 @@
+/*
+Benchmark of the fitness dispatch in the PSO: runs the same optimization with the fitness given as a compile-time
+policy (inlined into the evaluation loop) and as a type-erased FitnessFunction (one indirect call per evaluation).
+Both runs start from the same seed, so they must find the same cost.
+
+Usage:
+    ./bench_pso [scenario_file] [num_iterations] [num_particles]
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+
+#include "Problem.hpp"
+#include "PSO.hpp"
+
+using namespace std;
+
+const int NUM_WAYPOINTS = 5;
+const double C1 = 2.0;
+const double C2 = 2.0;
+const double W = 0.75;
+
+// Runs optimize with the given fitness and returns the time per fitness evaluation in ns
+template <typename Run>
+double timeRun(const Problem& problem, int num_iterations, int num_particles, const Run& run, double& cost) {
+    PSO pso(problem, num_particles, NUM_WAYPOINTS, 1, 42);
+    auto t0 = chrono::steady_clock::now();
+    cost = run(pso).second;
+    auto t1 = chrono::steady_clock::now();
+    return chrono::duration<double, nano>(t1 - t0).count() / (double(num_iterations) * num_particles);
+}
+
+template <typename Policy>
+void compare(const string& name, const Problem& problem, int num_iterations, int num_particles, const FitnessFunction& erased) {
+    double policy_cost, erased_cost;
+    double policy_ns = timeRun(problem, num_iterations, num_particles, [&](PSO& pso) {
+        return pso.optimize<Policy>(problem, num_iterations, C1, C2, W);
+    }, policy_cost);
+    double erased_ns = timeRun(problem, num_iterations, num_particles, [&](PSO& pso) {
+        return pso.optimize(problem, num_iterations, C1, C2, W, erased);
+    }, erased_cost);
+
+    cout << setw(16) << name << setw(16) << fixed << setprecision(1) << policy_ns << setw(20) << erased_ns
+         << setw(10) << setprecision(3) << erased_ns / policy_ns
+         << (policy_cost == erased_cost ? "" : "   MISMATCH") << endl;
+}
+
+int main(int argc, char* argv[]) {
+    string scenario = argc > 1 ? argv[1] : "assets/scenarios/scenario1.txt";
+    int num_iterations = argc > 2 ? stoi(argv[2]) : 2000;
+    int num_particles = argc > 3 ? stoi(argv[3]) : 500;
+
+    Problem problem;
+    if (!problem.loadScenario(scenario)) {
+        return 1;
+    }
+
+    cout << setw(16) << "fitness" << setw(16) << "policy (ns)" << setw(20) << "type-erased (ns)" << setw(10) << "ratio" << endl;
+    compare<Fitness>("fitness", problem, num_iterations, num_particles, fitness);
+    compare<FitnessRefined>("fitness_refined", problem, num_iterations, num_particles, fitness_refined);
+    return 0;
+}
@@ -0,0 +1,91 @@
+/*
+Benchmark of the RRT* tree growth: measures the average cost of one buildRRT iteration as the tree grows,
+and compares the nearest-neighbor query of the k-d tree against a linear scan over the vertices.
+
+Usage:
+    ./bench_rrt [max_vertices]
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+
+#include "Problem.hpp"
+#include "RRT.hpp"
+#include "utils.hpp"
+
+using namespace std;
+
+volatile long sink; // Results are accumulated here, so that the timed queries are not optimized away
+
+// Obstacle-free 1000x1000 map whose goal is enclosed in an obstacle, so the tree keeps growing and never connects to it
+Problem benchProblem() {
+    Problem problem;
+    problem.x_max = 1000.0;
+    problem.y_max = 1000.0;
+    problem.start1 = Point(0.0, 0.0);
+    problem.goal1 = Point(950.0, 950.0);
+    problem.start2 = problem.start1;
+    problem.goal2 = problem.goal1;
+    problem.radius = 1.0;
+    Obstacle obs;
+    obs.ll_corner = Point(900.0, 900.0);
+    obs.lx = 100.0;
+    obs.ly = 100.0;
+    problem.obstacles.push_back(obs);
+    return problem;
+}
+
+int linearNearest(const Tree& tree, const Point& q) {
+    int best = 0;
+    for (size_t i = 1; i < tree.vertices.size(); i++) {
+        if (euclideanDistance(tree.vertices[i], q) < euclideanDistance(tree.vertices[best], q)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    size_t max_vertices = argc > 1 ? stoul(argv[1]) : 64000;
+    Problem problem = benchProblem();
+    RRT rrt(problem, 42);
+    const double delta_s = 10.0;
+    const double delta_r = 20.0;
+    const int num_queries = 2000;
+
+    cout << setw(10) << "vertices" << setw(18) << "us/iteration" << setw(20) << "kd nearest (ns)" << setw(22) << "linear nearest (ns)" << endl;
+
+    size_t target = 1000;
+    while (target <= max_vertices) {
+        // Grow the tree up to the target size, timing the iterations of this stage only
+        size_t before = rrt.tree.vertices.size();
+        auto t0 = chrono::steady_clock::now();
+        while (rrt.tree.vertices.size() < target) {
+            rrt.buildRRT(problem, delta_s, delta_r, 100);
+        }
+        auto t1 = chrono::steady_clock::now();
+        double us_per_iteration = chrono::duration<double, micro>(t1 - t0).count() / (rrt.tree.vertices.size() - before);
+
+        // Time the nearest-neighbor queries alone on the current tree
+        long checksum = 0;
+        auto t2 = chrono::steady_clock::now();
+        for (int q = 0; q < num_queries; q++) {
+            checksum += rrt.tree.index.nearest(rrt.randomSample_naive(problem));
+        }
+        auto t3 = chrono::steady_clock::now();
+        for (int q = 0; q < num_queries; q++) {
+            checksum -= linearNearest(rrt.tree, rrt.randomSample_naive(problem));
+        }
+        auto t4 = chrono::steady_clock::now();
+        double kd_ns = chrono::duration<double, nano>(t3 - t2).count() / num_queries;
+        double linear_ns = chrono::duration<double, nano>(t4 - t3).count() / num_queries;
+
+        cout << setw(10) << rrt.tree.vertices.size() << setw(18) << fixed << setprecision(2) << us_per_iteration
+             << setw(20) << setprecision(0) << kd_ns << setw(22) << linear_ns << endl;
+        sink = checksum;
+        target *= 2;
+    }
+    return 0;
+}
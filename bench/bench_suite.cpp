@@ -0,0 +1,525 @@
+/*
+Microbenchmarks of the hot paths: geometric predicates, collision queries, fitness functions, one PSO iteration,
+RRT growth at several tree sizes and obstacle counts, and collision and point queries on generated scenarios of growing size. Each benchmark is calibrated to run about TARGET_REP_NS per
+repetition, and reports the mean and standard deviation of ns/op over REPETITIONS repetitions.
+
+Usage:
+    ./bench_suite [--filter <substring>] [--save <baseline.json>] [--compare <baseline.json>] [--threshold <fraction>]
+    ./bench_suite --check
+
+--save writes the results as a JSON baseline. --compare flags the benchmarks slower than the baseline by more than the
+threshold (0.10 by default) and by more than twice their combined standard deviation, and exits with status 1 if any.
+--check runs no benchmark, but checks the fast paths against their references: every obstacle kernel supported by the
+CPU against the scalar functions of utils.hpp, the KD-tree filled concurrently against brute-force nearest and radius
+queries, and the trees grown by the parallel RRT* for consistency. It exits with status 1 on any mismatch.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <thread>
+#include <algorithm>
+
+#include "Problem.hpp"
+#include "PSO.hpp"
+#include "PSOEngine.hpp"
+#include "RRT.hpp"
+#include "DistanceField.hpp"
+#include "Random.hpp"
+#include "Sampler.hpp"
+#include "ScenarioGenerator.hpp"
+#include "utils.hpp"
+
+using namespace std;
+
+const int REPETITIONS = 10;
+const double TARGET_REP_NS = 2e7; // 20 ms per repetition
+const int NUM_INPUTS = 1024; // Inputs are cycled through, so that branch predictors do not learn a single case
+const int CHECK_SEGMENTS = 200000; // Random segments compared per obstacle kernel by --check
+const int CHECK_POINTS = 20000; // Points inserted concurrently in the KD-tree checked by --check
+const int CHECK_THREADS = 4;
+
+struct Measurement{
+    string name;
+    double ns_per_op;
+    double stddev_ns;
+    int repetitions;
+};
+
+volatile double sink; // Results are accumulated here, so that the measured calls are not optimized away
+
+/*
+@brief Times op(i) for i = 0, 1, 2, ..., which performs ops_per_call operations per call.
+The number of calls per repetition is doubled until a repetition lasts TARGET_REP_NS, or reaches max_calls.
+reset, if given, is called before each repetition and is not timed, e.g. to restore a state the calls modify.
+*/
+Measurement measure(const string& name, const function<double(int)>& op, int ops_per_call = 1, long max_calls = 1L << 40,
+    const function<void()>& reset = nullptr) {
+    auto run = [&](long calls) {
+        if (reset) {
+            reset();
+        }
+        double acc = 0.0;
+        auto t0 = chrono::steady_clock::now();
+        for (long i = 0; i < calls; ++i) {
+            acc += op(i);
+        }
+        auto t1 = chrono::steady_clock::now();
+        sink = acc;
+        return chrono::duration<double, nano>(t1 - t0).count();
+    };
+
+    long calls = 1;
+    while (calls < max_calls && run(calls) < TARGET_REP_NS / 4) {
+        calls *= 2;
+    }
+    calls = min(4 * calls, max_calls);
+
+    vector<double> samples;
+    for (int r = 0; r < REPETITIONS; ++r) {
+        samples.push_back(run(calls) / (double(calls) * ops_per_call));
+    }
+    double mean = 0.0;
+    for (double s : samples) {
+        mean += s;
+    }
+    mean /= samples.size();
+    double variance = 0.0;
+    for (double s : samples) {
+        variance += (s - mean) * (s - mean);
+    }
+    variance /= samples.size() - 1;
+    return {name, mean, sqrt(variance), REPETITIONS};
+}
+
+// Square map of side 1000 with num_obstacles random obstacles kept away from the start, and the goal enclosed in an obstacle
+// so that RRT never reaches it and keeps growing
+Problem randomProblem(int num_obstacles, RandomStream& rng) {
+    Problem problem;
+    problem.x_max = 1000.0;
+    problem.y_max = 1000.0;
+    problem.start1 = Point(0.0, 0.0);
+    problem.goal1 = Point(975.0, 975.0);
+    problem.start2 = problem.start1;
+    problem.goal2 = problem.goal1;
+    problem.radius = 1.0;
+    Obstacle goal_box;
+    goal_box.ll_corner = Point(950.0, 950.0);
+    goal_box.lx = 50.0;
+    goal_box.ly = 50.0;
+    problem.obstacles.push_back(goal_box);
+    double side = num_obstacles > 0 ? 300.0 / sqrt(double(num_obstacles)) : 0.0; // About 9% of the map covered
+    while (int(problem.obstacles.size()) < num_obstacles + 1) {
+        Obstacle obs;
+        obs.lx = rng.uniform(0.5, 1.5) * side;
+        obs.ly = rng.uniform(0.5, 1.5) * side;
+        obs.ll_corner = Point(rng.uniform(0.0, problem.x_max - obs.lx), rng.uniform(0.0, problem.y_max - obs.ly));
+        if (obs.ll_corner.x < 50.0 && obs.ll_corner.y < 50.0) {
+            continue;
+        }
+        problem.obstacles.push_back(obs);
+    }
+    problem.buildIndex();
+    return problem;
+}
+
+vector<Point> randomPoints(int n, const Problem& problem, RandomStream& rng) {
+    vector<Point> points;
+    for (int i = 0; i < n; ++i) {
+        points.emplace_back(rng.uniform() * problem.x_max, rng.uniform() * problem.y_max);
+    }
+    return points;
+}
+
+vector<Measurement> runBenchmarks(const string& filter) {
+    vector<Measurement> results;
+    auto add = [&](const string& name, const function<double(int)>& op, int ops_per_call = 1, long max_calls = 1L << 40,
+        const function<void()>& reset = nullptr) {
+        if (name.find(filter) == string::npos) {
+            return;
+        }
+        results.push_back(measure(name, op, ops_per_call, max_calls, reset));
+        const Measurement& m = results.back();
+        cout << setw(44) << left << m.name << right << setw(14) << fixed << setprecision(1) << m.ns_per_op
+             << setw(10) << setprecision(1) << 100.0 * m.stddev_ns / m.ns_per_op << " %" << endl;
+    };
+    RandomStream rng(0, streamId(StreamDomain::USER, 12));
+
+    // Geometric predicates
+    Problem empty = randomProblem(0, rng);
+    vector<Point> p = randomPoints(4 * NUM_INPUTS, empty, rng);
+    add("geometry/segmentsIntersect", [&](int i) {
+        int k = 4 * (i % NUM_INPUTS);
+        return double(segmentsIntersect(p[k], p[k + 1], p[k + 2], p[k + 3]));
+    });
+
+    for (int num_obstacles : {16, 256}) {
+        Problem problem = randomProblem(num_obstacles, rng);
+        vector<Point> q = randomPoints(2 * NUM_INPUTS, problem, rng);
+        string suffix = "/" + to_string(num_obstacles);
+        add("geometry/segmentIntersectsObstacles" + suffix, [&](int i) {
+            int k = 2 * (i % NUM_INPUTS);
+            return double(segmentIntersectsObstacles(q[k], q[k + 1], problem.obstacles));
+        });
+        add("geometry/segmentCollisionDistance" + suffix, [&](int i) {
+            int k = 2 * (i % NUM_INPUTS);
+            return segmentCollisionDistance(q[k], q[k + 1], problem.obstacles);
+        });
+        add("problem/isCollision" + suffix, [&](int i) {
+            int k = 2 * (i % NUM_INPUTS);
+            return double(problem.isCollision(q[k], q[k + 1]));
+        });
+        add("problem/collisionDistance" + suffix, [&](int i) {
+            int k = 2 * (i % NUM_INPUTS);
+            return problem.collisionDistance(q[k], q[k + 1]);
+        });
+    }
+
+    // Fitness of random 5-waypoint paths
+    Problem problem = randomProblem(64, rng);
+    vector<vector<Point>> paths;
+    for (int i = 0; i < NUM_INPUTS; ++i) {
+        paths.push_back(randomPoints(5, problem, rng));
+    }
+    add("fitness/fitness", [&](int i) { return fitness(paths[i % NUM_INPUTS], problem); });
+    add("fitness/fitness_refined", [&](int i) { return fitness_refined(paths[i % NUM_INPUTS], problem); });
+
+    // Signed distance and gradient, as read by the path refiner
+    DistanceField field;
+    field.build(problem);
+    add("distance_field/gradient", [&](int i) {
+        Point gradient;
+        return field.distance(paths[i % NUM_INPUTS][0], gradient) + gradient.x;
+    });
+
+    // Samples of the RRT planners, from the mixture of the intelligent sampling with a goal bias
+    vector<Point> obstacle_vertices = problem.verticesObstacles();
+    vector<Point> edge_points = problem.pointsNearObstacles(1000);
+    Sampler sampler(problem, problem.goal1, obstacle_vertices, edge_points);
+    sampler.setWeights({{SamplingStrategy::UNIFORM, 0.25}, {SamplingStrategy::OBSTACLE_VERTICES, 0.4},
+                        {SamplingStrategy::OBSTACLE_EDGES, 0.3}, {SamplingStrategy::GOAL, 0.05}});
+    RandomStream sampler_stream(12, streamId(StreamDomain::USER, 0));
+    add("sampler/mixture", [&](int) { return sampler.next(sampler_stream).x; });
+
+    // One iteration of the plain PSO, 200 particles of 5 waypoints, on a single thread
+    PSO pso(problem, 200, 5, 1, 12);
+    PSOEngine<FitnessRefined> engine(pso, problem, 2.0, 2.0, 0.75);
+    engine.init();
+    add("pso/iteration", [&](int) {
+        engine.step();
+        return pso.global_best_cost;
+    });
+
+    // RRT iterations at several tree sizes. Each repetition starts again from the same tree, and adds at most 10% to it.
+    for (int num_obstacles : {0, 256}) {
+        Problem rrt_problem = randomProblem(num_obstacles, rng);
+        RRT grown(rrt_problem, 12);
+        for (size_t tree_size : {1000, 8000}) {
+            while (grown.tree.vertices.size() < tree_size) {
+                grown.buildRRT(rrt_problem, 10.0, 20.0, 100);
+            }
+            RRT rrt = grown;
+            const int iterations_per_call = 10;
+            add("rrt/iteration/" + to_string(num_obstacles) + "_obstacles/" + to_string(tree_size) + "_vertices", [&](int) {
+                return double(rrt.buildRRT(rrt_problem, 10.0, 20.0, iterations_per_call));
+            }, iterations_per_call, tree_size / 10 / iterations_per_call, [&] { rrt = grown; });
+        }
+    }
+
+    // Scaling of the collision queries with the obstacle count, on generated scenarios of constant obstacle density.
+    // The segments stay about 100 units long, so that only the cost of the index grows with the map.
+    for (const char* layout_name : {"clutter", "warehouse", "maze", "narrow"}) {
+        for (int num_obstacles : {1000, 100000}) {
+            ScenarioSpec spec;
+            parseLayout(layout_name, spec.layout);
+            spec.width = spec.height = 100.0 * sqrt(double(num_obstacles));
+            spec.num_obstacles = num_obstacles;
+            spec.clearance = 5.0;
+            Problem generated;
+            if (!generateScenario(spec, generated)) {
+                continue;
+            }
+            vector<Point> q = randomPoints(NUM_INPUTS, generated, rng);
+            for (int i = 0; i < NUM_INPUTS; ++i) {
+                q.emplace_back(q[i].x + rng.uniform(-50.0, 50.0), q[i].y + rng.uniform(-50.0, 50.0));
+            }
+            add("scaling/isCollision/" + string(layout_name) + "/" + to_string(num_obstacles), [&](int i) {
+                int k = i % NUM_INPUTS;
+                return double(generated.isCollision(q[k], q[NUM_INPUTS + k]));
+            });
+            add("scaling/isOccupied/" + string(layout_name) + "/" + to_string(num_obstacles), [&](int i) {
+                return double(generated.isOccupied(q[i % NUM_INPUTS]));
+            });
+        }
+    }
+    return results;
+}
+
+void saveBaseline(const string& filename, const vector<Measurement>& results) {
+    ofstream out(filename);
+    out << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Measurement& m = results[i];
+        out << "    {\"name\": \"" << m.name << "\", \"ns_per_op\": " << setprecision(6) << m.ns_per_op
+            << ", \"stddev_ns\": " << m.stddev_ns << ", \"repetitions\": " << m.repetitions << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+// Reads a baseline written by saveBaseline, one benchmark per line
+map<string, Measurement> loadBaseline(const string& filename) {
+    map<string, Measurement> baseline;
+    ifstream in(filename);
+    if (!in.is_open()) {
+        cerr << "Error: Could not open baseline " << filename << endl;
+        return baseline;
+    }
+    auto field = [](const string& line, const string& key) {
+        size_t pos = line.find("\"" + key + "\": ");
+        return pos == string::npos ? string() : line.substr(pos + key.size() + 4);
+    };
+    string line;
+    while (getline(in, line)) {
+        string name = field(line, "name");
+        if (name.empty()) {
+            continue;
+        }
+        Measurement m;
+        m.name = name.substr(1, name.find('"', 1) - 1);
+        m.ns_per_op = stod(field(line, "ns_per_op"));
+        m.stddev_ns = stod(field(line, "stddev_ns"));
+        m.repetitions = stoi(field(line, "repetitions"));
+        baseline[m.name] = m;
+    }
+    return baseline;
+}
+
+int compare(const vector<Measurement>& results, const map<string, Measurement>& baseline, double threshold) {
+    cout << endl << setw(44) << left << "benchmark" << right << setw(14) << "baseline (ns)" << setw(14) << "now (ns)" << setw(10) << "change" << endl;
+    int regressions = 0;
+    for (const Measurement& m : results) {
+        auto it = baseline.find(m.name);
+        if (it == baseline.end()) {
+            cout << setw(44) << left << m.name << right << setw(14) << "-" << setw(14) << fixed << setprecision(1) << m.ns_per_op << "       new" << endl;
+            continue;
+        }
+        const Measurement& b = it->second;
+        double change = (m.ns_per_op - b.ns_per_op) / b.ns_per_op;
+        double noise = 2.0 * sqrt(m.stddev_ns * m.stddev_ns + b.stddev_ns * b.stddev_ns);
+        bool regression = change > threshold && m.ns_per_op - b.ns_per_op > noise;
+        regressions += regression;
+        cout << setw(44) << left << m.name << right << setw(14) << fixed << setprecision(1) << b.ns_per_op << setw(14) << m.ns_per_op
+             << setw(9) << showpos << setprecision(1) << 100.0 * change << noshowpos << "%" << (regression ? "  REGRESSION" : "") << endl;
+    }
+    cout << regressions << " regression(s) above " << 100.0 * threshold << "%" << endl;
+    return regressions > 0 ? 1 : 0;
+}
+
+// Random rectangles and segments on a coarse integer lattice half of the time, so that touching corners, shared edges,
+// axis-parallel and zero-length segments, the degenerate cases of the kernels, come up often
+int checkObstacleKernels() {
+    RandomStream rng(0, streamId(StreamDomain::USER, 13));
+    auto coordinate = [&](double lo, double hi) { return rng.uniform() < 0.5 ? std::floor(rng.uniform(lo, hi + 1.0)) : rng.uniform(lo, hi); };
+    vector<Obstacle> obstacles;
+    for (int i = 0; i < 37; ++i) { // Not a multiple of ObstacleBounds::LANES, for the tails of the kernels
+        Obstacle obs;
+        obs.ll_corner = Point(coordinate(0.0, 16.0), coordinate(0.0, 16.0));
+        obs.lx = std::max(1.0, std::floor(rng.uniform(0.0, 5.0)));
+        obs.ly = std::max(1.0, std::floor(rng.uniform(0.0, 5.0)));
+        obstacles.push_back(obs);
+    }
+    ObstacleBounds bounds;
+    bounds.assign(obstacles);
+
+    const string selected = obstacleKernelName();
+    int failures = 0;
+    for (const string kernel : {"scalar", "sse2", "avx2"}) {
+        if (!selectObstacleKernel(kernel)) {
+            cout << "check/kernel/" << kernel << ": not supported by this CPU, skipped" << endl;
+            continue;
+        }
+        RandomStream segments(0, streamId(StreamDomain::USER, 14)); // Same segments for every kernel
+        auto point = [&]() { return segments.uniform() < 0.5 ? Point(std::floor(segments.uniform(0.0, 21.0)), std::floor(segments.uniform(0.0, 21.0)))
+                                                             : Point(segments.uniform(0.0, 20.0), segments.uniform(0.0, 20.0)); };
+        int hit_mismatches = 0, penetration_mismatches = 0;
+        double worst_error = 0.0;
+        for (int k = 0; k < CHECK_SEGMENTS; ++k) {
+            Point p1 = point();
+            Point p2 = segments.uniform() < 0.05 ? p1 : point();
+            size_t begin = segments.uniformIndex(obstacles.size() + 1);
+            size_t end = begin + segments.uniformIndex(obstacles.size() - begin + 1);
+            double t_start = segments.uniform() < 0.5 ? 0.0 : segments.uniform(0.0, 0.5);
+            double t_end = segments.uniform() < 0.5 ? 1.0 : segments.uniform(0.5, 1.0);
+
+            bool hit = false;
+            double penetration = 0.0;
+            for (size_t i = begin; i < end; ++i) {
+                hit = hit || segmentIntersectsObstacle(p1, p2, obstacles[i]);
+                penetration += segmentCollisionDistance(p1, p2, obstacles[i], t_start, t_end);
+            }
+            if (segmentHitsBounds(bounds, begin, end, p1, p2) != hit) {
+                if (hit_mismatches++ == 0) {
+                    cout << setprecision(17) << "    first hit mismatch: (" << p1.x << ", " << p1.y << ") -> (" << p2.x << ", " << p2.y
+                         << "), rectangles " << begin << " to " << end << ", reference " << hit << endl;
+                }
+            }
+            double error = std::abs(segmentPenetrationBounds(bounds, begin, end, p1, p2, t_start, t_end) - penetration);
+            worst_error = std::max(worst_error, error);
+            penetration_mismatches += error > 1e-9 * std::max(1.0, penetration); // Only the order of the summation differs
+        }
+        bool ok = hit_mismatches == 0 && penetration_mismatches == 0;
+        failures += !ok;
+        cout << "check/kernel/" << kernel << ": " << CHECK_SEGMENTS << " segments, " << hit_mismatches << " hit and " << penetration_mismatches
+             << " penetration mismatches (largest error " << scientific << setprecision(1) << worst_error << defaultfloat << ") "
+             << (ok ? "OK" : "FAILED") << endl;
+    }
+    selectObstacleKernel(selected);
+    return failures;
+}
+
+// Nearest and radius queries of tree against a scan of points, the ids of tree being the indices in points
+int checkKDTreeQueries(const string& name, const KDTree& tree, const vector<Point>& points, RandomStream& rng) {
+    int mismatches = 0;
+    vector<int> found, expected;
+    for (int k = 0; k < 2000; ++k) {
+        Point q(rng.uniform(-50.0, 1050.0), rng.uniform(-50.0, 1050.0));
+        int best = -1;
+        double best_dist2 = 0.0;
+        for (size_t i = 0; i < points.size(); ++i) {
+            double dx = points[i].x - q.x, dy = points[i].y - q.y;
+            if (best == -1 || dx * dx + dy * dy < best_dist2) {
+                best = i;
+                best_dist2 = dx * dx + dy * dy;
+            }
+        }
+        mismatches += tree.nearest(q) != best;
+
+        double r = rng.uniform(0.0, 60.0);
+        expected.clear();
+        for (size_t i = 0; i < points.size(); ++i) {
+            if (euclideanDistance(points[i], q) < r) {
+                expected.push_back(i);
+            }
+        }
+        tree.radius(q, r, found);
+        mismatches += found != expected;
+    }
+    cout << "check/" << name << ": " << points.size() << " points, " << mismatches << " query mismatches " << (mismatches ? "FAILED" : "OK") << endl;
+    return mismatches > 0;
+}
+
+int checkConcurrentKDTree() {
+    RandomStream rng(0, streamId(StreamDomain::USER, 15));
+    Problem square = randomProblem(0, rng);
+    vector<Point> points = randomPoints(CHECK_POINTS, square, rng);
+    for (int i = 0; i < CHECK_POINTS / 10; ++i) {
+        points[rng.uniformIndex(CHECK_POINTS)] = points[rng.uniformIndex(CHECK_POINTS)]; // Duplicates, and ties on the splitting coordinates
+    }
+
+    // The first points inserted sequentially, the others by CHECK_THREADS threads racing for the links, as buildRRTParallel does
+    KDTree tree;
+    const int sequential = CHECK_POINTS / 100;
+    for (int i = 0; i < sequential; ++i) {
+        tree.insert(points[i], i);
+    }
+    tree.reserveConcurrent(CHECK_POINTS);
+    vector<thread> threads;
+    for (int t = 0; t < CHECK_THREADS; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = sequential + t; i < CHECK_POINTS; i += CHECK_THREADS) {
+                tree.insertConcurrent(points[i], i);
+                tree.nearest(points[i]); // Queries racing with the insertions of the other threads
+            }
+        });
+    }
+    for (thread& th : threads) {
+        th.join();
+    }
+    tree.finishConcurrent(CHECK_POINTS);
+    return checkKDTreeQueries("kdtree/concurrent", tree, points, rng);
+}
+
+// Tree grown by the parallel RRT*: a single root, no cycle, exact costs, collision-free edges, and an index holding every vertex
+int checkParallelRRT() {
+    RandomStream rng(0, streamId(StreamDomain::USER, 16));
+    int failures = 0;
+    for (int num_obstacles : {16, 256}) {
+        Problem problem = randomProblem(num_obstacles, rng);
+        RRT rrt(problem, 1);
+        rrt.num_threads = CHECK_THREADS;
+        rrt.buildRRT(problem, 20.0, 50.0, 5000);
+        const Tree& tree = rrt.tree;
+        const int n = tree.vertices.size();
+        int errors = tree.parents[0] != -1 || tree.costs[0] != 0.0;
+        for (int i = 1; i < n; ++i) {
+            int parent = tree.parents[i];
+            if (parent < 0 || parent >= n || parent == i) {
+                errors++;
+                continue;
+            }
+            double cost = tree.costs[parent] + euclideanDistance(tree.vertices[parent], tree.vertices[i]);
+            errors += std::abs(tree.costs[i] - cost) > 1e-9 * std::max(1.0, cost);
+            errors += problem.isCollision(tree.vertices[parent], tree.vertices[i]);
+            int steps = 0; // Reaches the root within n steps unless there is a cycle
+            for (int j = i; j != 0 && steps <= n; j = tree.parents[j], ++steps) {}
+            errors += steps > n;
+        }
+        cout << "check/rrt/parallel/" << num_obstacles << ": " << n << " vertices, " << errors << " inconsistencies " << (errors ? "FAILED" : "OK") << endl;
+        failures += errors > 0;
+        failures += checkKDTreeQueries("rrt/parallel/" + to_string(num_obstacles) + "/index", tree.index, tree.vertices, rng);
+    }
+    return failures;
+}
+
+int runChecks() {
+    int failures = checkObstacleKernels() + checkConcurrentKDTree() + checkParallelRRT();
+    cout << failures << " check(s) failed" << endl;
+    return failures > 0 ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    string filter, save_file, compare_file;
+    double threshold = 0.10;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (i + 1 < argc && arg == "--filter") {
+            filter = argv[++i];
+        } else if (i + 1 < argc && arg == "--save") {
+            save_file = argv[++i];
+        } else if (i + 1 < argc && arg == "--compare") {
+            compare_file = argv[++i];
+        } else if (i + 1 < argc && arg == "--threshold") {
+            threshold = stod(argv[++i]);
+        } else if (arg == "--check") {
+            return runChecks();
+        } else {
+            cerr << "Usage: " << argv[0] << " [--filter <substring>] [--save <baseline.json>] [--compare <baseline.json>] [--threshold <fraction>] | --check" << endl;
+            return 1;
+        }
+    }
+
+    cout << "Obstacle kernels: " << obstacleKernelName() << endl;
+    cout << setw(44) << left << "benchmark" << right << setw(14) << "ns/op" << setw(12) << "stddev" << endl;
+    vector<Measurement> results = runBenchmarks(filter);
+
+    if (!save_file.empty()) {
+        saveBaseline(save_file, results);
+        cout << "Baseline saved to " << save_file << endl;
+    }
+    if (!compare_file.empty()) {
+        map<string, Measurement> baseline = loadBaseline(compare_file);
+        if (baseline.empty()) {
+            return 1;
+        }
+        return compare(results, baseline, threshold);
+    }
+    return 0;
+}
@@ -0,0 +1,52 @@
+/*
+Batch mode: runs every combination of scenarios, seeds, algorithms and hyperparameter values listed in a manifest,
+in parallel, and streams one result row per run as CSV or JSON lines.
+
+The manifest has one setting per line, a key followed by its values, and # starts a comment:
+    scenarios assets/scenarios/scenario1.txt assets/scenarios/scenario2.txt
+    seeds 1:20                  (a list of seeds, or an inclusive range first:last with first <= last, 1000000 seeds at most)
+    algorithms pso_dimensional rrt
+    particles 100 500           (any hyperparameter may list several values, each one multiplies the number of jobs)
+    output results.csv          (standard output if omitted)
+    format csv                  (csv or json)
+    threads 8                   (parallel jobs, all hardware threads if omitted)
+*/
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <cstdint>
+
+
+struct BatchJob{
+    int id;
+    int scenario; // Index in BatchManifest::scenarios
+    std::string algorithm;
+    uint64_t seed;
+    std::vector<std::string> values; // values[i] is the value of BatchManifest::sweeps[i] for this job
+};
+
+struct BatchResult{
+    double cost = 0.0;
+    int iterations = 0;
+    double wall_time = 0.0; // Seconds
+    bool success = false; // Collision-free path from start to goal
+};
+
+struct BatchManifest{
+    std::vector<std::string> scenarios;
+    std::vector<uint64_t> seeds;
+    std::vector<std::string> algorithms;
+    std::vector<std::pair<std::string, std::vector<std::string>>> sweeps; // Hyperparameters, in manifest order, with their values
+    std::string output; // Empty for standard output
+    std::string format = "csv";
+    int num_threads = 0; // 0 for all hardware threads
+
+    bool load(const std::string& filename); // Parses and checks a manifest, reports errors on std::cerr
+    std::vector<BatchJob> jobs() const; // Every combination: by scenario, then algorithm, then hyperparameters, with the seeds of a configuration consecutive
+    std::string value(const BatchJob& job, const std::string& key, const std::string& fallback) const; // Hyperparameter of a job
+};
+
+int runBatch(const std::string& manifest_file); // Returns the exit code of the program
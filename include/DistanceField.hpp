@@ -0,0 +1,31 @@
+/*
+Signed Euclidean distance to the obstacles, sampled on a regular grid of nodes covering the environment and
+interpolated bilinearly in between, so that the distance and its gradient are available anywhere in constant time.
+The samples come from an exact Euclidean distance transform of the occupancy of the nodes (Felzenszwalb and
+Huttenlocher, linear in the number of nodes), so they are exact up to the node spacing.
+*/
+
+#pragma once
+
+#include <vector>
+
+struct Point;
+class Problem;
+
+
+class DistanceField{
+public:
+    void build(const Problem& problem, double spacing = 0.0); // spacing between nodes, 0 for about MAX_NODES_PER_AXIS nodes along the longer side
+    bool empty() const { return values.empty(); }
+
+    double distance(const Point& p) const; // Positive outside the obstacles, negative inside. Outside the map, decreases with the distance to it
+    double distance(const Point& p, Point& gradient) const; // Same value, and its gradient with respect to p
+
+    int nx = 0, ny = 0; // Number of nodes along x and y
+    double cell_w = 0.0, cell_h = 0.0; // Spacing between nodes
+
+private:
+    std::vector<double> values; // values[j * nx + i] is the signed distance at (i * cell_w, j * cell_h)
+
+    double interpolate(const Point& p, Point* gradient) const;
+};
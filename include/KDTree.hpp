@@ -0,0 +1,42 @@
+/*
+Incremental 2-d tree over the vertices of an RRT tree.
+Nodes are never moved nor removed once linked, so after reserveConcurrent several threads can insert with
+insertConcurrent while others query: a node is written first, then published by linking it to its parent with a
+compare-and-swap, and the queries only reach nodes through those links.
+*/
+
+#pragma once
+
+#include <vector>
+#include <atomic>
+
+#include "Problem.hpp"
+
+
+class KDTree{
+public:
+    void insert(const Point& p, int id); // Inserts point p, identified by id (its index in the owning Tree)
+    int nearest(const Point& q) const; // Returns the id of the point closest to q, or -1 if the tree is empty
+    void radius(const Point& q, double r, std::vector<int>& out) const; // Fills out with the ids of the points at distance strictly less than r from q, in increasing id order
+    void clear();
+    std::size_t size() const { return nodes.size(); }
+
+    void reserveConcurrent(std::size_t capacity); // Allocates the nodes of the ids below capacity. Requires every id inserted so far to equal its insertion rank
+    void insertConcurrent(const Point& p, int id); // Thread-safe insert, after reserveConcurrent, of an id below capacity not inserted yet
+    void finishConcurrent(std::size_t size); // Back to sequential use once the ids 0 to size - 1 are all inserted, drops the other reserved nodes
+
+private:
+    struct Node{
+        Point p;
+        int id = -1;
+        std::atomic<int> left{-1}, right{-1}; // Indices of the children in nodes, -1 if none
+        int axis = 0; // 0 splits on x, 1 splits on y
+
+        Node() = default;
+        Node(const Point& p, int id) : p(p), id(id) {}
+        Node(const Node& other) { *this = other; }
+        Node& operator=(const Node& other);
+    };
+
+    std::vector<Node> nodes; // Nodes are stored in insertion order, nodes[0] is the root
+};
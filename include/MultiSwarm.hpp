@@ -0,0 +1,114 @@
+/*
+Island model of the PSO: several independent swarms (islands), each running on its own thread with its own random
+streams, which periodically send copies of their best particles to their neighbors. The islands replace the random
+restarts: a swarm that converged to a poor path gets new particles from the others instead of being thrown away.
+
+Migrations are synchronized pairwise with atomic epoch counters, without locks: an island only waits for the neighbors
+it receives from, and for its own migrants to be read before overwriting them. Every island receives the migrants its
+neighbors had after the same number of iterations, so a run is reproducible for a given seed and number of islands.
+*/
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <tuple>
+
+#include "PSO.hpp"
+#include "PSOEngine.hpp"
+
+
+enum class MigrationTopology{
+    RING, // Island k receives from island k - 1
+    FULLY_CONNECTED // Every island receives from all the others
+};
+
+struct IslandStats{
+    std::vector<Point> best_waypoints; // Best path found by the island
+    double best_cost = 0.0;
+    int migrants_accepted = 0; // Immigrants that replaced one of the particles of the island
+    double wait_time = 0.0; // Seconds spent waiting for the neighbors at migrations
+};
+
+class MultiSwarm{
+public:
+    std::vector<PSO> islands;
+    std::vector<IslandStats> stats; // Statistics of the last optimize, per island
+    std::vector<Point> global_best_waypoints;
+    double global_best_cost;
+    int best_island = 0; // Island that found global_best_waypoints
+
+    // num_particles is the number of particles of each island
+    MultiSwarm(const Problem& problem, int num_islands, int num_particles, int num_waypoints, uint64_t seed = masterSeed());
+
+    // Runs num_iterations iterations of the engine on every island, with a migration every migration_interval iterations,
+    // where each island sends copies of the personal bests of its num_migrants best particles.
+    template <typename FitnessFn, typename Acceptance = GreedyAcceptance, typename Learning = NoLearning>
+    std::pair<std::vector<Point>, double> optimize(const Problem& problem, int num_iterations, double c1, double c2, double w,
+        int migration_interval, int num_migrants, MigrationTopology topology, FitnessFn fitness = FitnessFn(),
+        Acceptance acceptance = Acceptance(), Learning learning = Learning());
+
+private:
+    struct Migrant{
+        std::vector<Point> waypoints;
+        double cost;
+    };
+
+    struct Mailbox{
+        std::vector<Migrant> slots[2]; // Migrants of the even and odd epochs, so an island can publish before its last ones are read
+        std::atomic<int> published{-1}; // Last epoch whose migrants are in the slots
+        std::atomic<int> consumed{-1}; // Last epoch whose migrants from the neighbors this island has read
+    };
+
+    std::unique_ptr<Mailbox[]> mailboxes;
+    MigrationTopology topology = MigrationTopology::RING;
+
+    std::vector<int> sources(int island) const; // Islands island receives from
+    std::vector<int> readers(int island) const; // Islands that receive from island
+    void migrate(int island, int epoch, int num_migrants); // Sends the migrants of island and takes in those of its sources
+    void collectResults();
+};
+
+
+template <typename FitnessFn, typename Acceptance, typename Learning>
+std::pair<std::vector<Point>, double> MultiSwarm::optimize(const Problem& problem, int num_iterations, double c1, double c2, double w,
+    int migration_interval, int num_migrants, MigrationTopology _topology, FitnessFn fitness, Acceptance acceptance, Learning learning) {
+    int num_islands = islands.size();
+    topology = _topology;
+    mailboxes = std::make_unique<Mailbox[]>(num_islands);
+    stats.assign(num_islands, IslandStats());
+
+    auto run_island = [&](int k) {
+        PSOEngine<FitnessFn, NoRestart, Acceptance, Learning> engine(islands[k], problem, c1, c2, w, fitness, NoRestart(),
+            acceptance, learning);
+        engine.init();
+        int epoch = 0;
+        for (int iter = 1; iter <= num_iterations; ++iter) {
+            engine.step();
+            if (num_islands > 1 && migration_interval > 0 && iter % migration_interval == 0 && iter < num_iterations) {
+                migrate(k, epoch++, num_migrants);
+            }
+        }
+        std::tie(stats[k].best_waypoints, stats[k].best_cost) = engine.best();
+    };
+
+    // Islands 1 to num_islands - 1 get their own threads, island 0 runs on the calling thread
+    std::vector<std::thread> threads;
+    for (int k = 1; k < num_islands; ++k) {
+        threads.emplace_back(run_island, k);
+    }
+    if (num_islands > 0) {
+        run_island(0);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    collectResults();
+    return {global_best_waypoints, global_best_cost};
+}
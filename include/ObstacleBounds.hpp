@@ -0,0 +1,51 @@
+/*
+Structure-of-arrays copy of the obstacle bounds, and the vectorized segment-vs-rectangle kernels working on it.
+The arrays are either owned or attached to external storage, such as a memory-mapped binary scenario file.
+The kernels process several rectangles per instruction (4 with AVX2, 2 with SSE2); the implementation is selected
+at runtime from the capabilities of the CPU. The scalar functions of utils.hpp remain the reference.
+*/
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstddef>
+
+struct Point;
+struct Obstacle; // Defined in Problem.hpp, which includes this header
+
+
+struct ObstacleBounds{
+    static const std::size_t LANES = 4; // Arrays are padded to a multiple of this with empty rectangles that never collide
+
+    void assign(const std::vector<Obstacle>& obstacles); // Copies the bounds of the obstacles, then pads
+    void attach(std::shared_ptr<const void> owner, const double* xmin, const double* xmax, const double* ymin, const double* ymax, std::size_t n); // Uses n padded bounds stored elsewhere (e.g. in a memory-mapped file) without copying them, owner keeps that storage alive
+    void push_back(const Obstacle& obs); // Appends one obstacle, without padding
+    void push_empty(); // Appends one empty rectangle, which never collides
+    void pad(); // Pads the arrays up to a multiple of LANES
+    void clear();
+    std::size_t size() const { return count; } // Number of rectangles, padding included
+    bool empty() const { return count == 0; }
+
+    const double* xmin() const { return owner ? attached[0] : storage[0].data(); }
+    const double* xmax() const { return owner ? attached[1] : storage[1].data(); }
+    const double* ymin() const { return owner ? attached[2] : storage[2].data(); }
+    const double* ymax() const { return owner ? attached[3] : storage[3].data(); }
+
+private:
+    std::vector<double> storage[4]; // xmin, xmax, ymin, ymax, when the bounds are not attached
+    std::shared_ptr<const void> owner; // Set while attached
+    const double* attached[4] = {nullptr, nullptr, nullptr, nullptr};
+    std::size_t count = 0;
+
+    void detach(); // Copies attached bounds into storage before modifying them
+};
+
+// Same result as segmentIntersectsObstacle on any of the rectangles begin to end - 1
+bool segmentHitsBounds(const ObstacleBounds& bounds, std::size_t begin, std::size_t end, const Point& p1, const Point& p2);
+// Same result as the sum of segmentCollisionDistance(p1, p2, obs, t_start, t_end) over the rectangles begin to end - 1
+double segmentPenetrationBounds(const ObstacleBounds& bounds, std::size_t begin, std::size_t end, const Point& p1, const Point& p2, double t_start = 0.0, double t_end = 1.0);
+
+std::string obstacleKernelName(); // Name of the kernels in use: "avx2", "sse2" or "scalar"
+bool selectObstacleKernel(const std::string& name); // Forces the given kernels (e.g. for benchmarks), returns false if the CPU does not support them
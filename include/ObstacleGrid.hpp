@@ -0,0 +1,48 @@
+/*
+Broad-phase index over the obstacles: a uniform grid covering the environment.
+Each cell lists the obstacles overlapping it, and segments are walked cell by cell (DDA traversal),
+so that only the obstacles near a segment get the exact tests. The bounds of the obstacles of each cell are
+stored contiguously, so the exact tests run on the vectorized kernels of ObstacleBounds.hpp.
+Like the bounds, the cell lists are either owned or attached to external storage (a memory-mapped binary scenario).
+*/
+
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include "ObstacleBounds.hpp"
+
+struct Point;
+struct Obstacle; // Defined in Problem.hpp, which includes this header
+
+
+class ObstacleGrid{
+public:
+    void build(const std::vector<Obstacle>& obstacles, double x_max, double y_max); // Builds the grid, the resolution is chosen from the number of obstacles
+    // Uses a grid stored elsewhere without copying it: nx * ny + 1 cell starts and the bounds they index, attached to the same storage, which owner keeps alive
+    void attach(std::shared_ptr<const void> owner, int nx, int ny, double x_max, double y_max, const int* cell_start, const ObstacleBounds& cell_bounds);
+    bool empty() const { return nx == 0; }
+
+    void clear();
+
+    bool segmentIntersects(const Point& p1, const Point& p2) const; // Same result as segmentIntersectsObstacles over the obstacles the grid was built from
+    double segmentCollisionDistance(const Point& p1, const Point& p2) const; // Same result as segmentCollisionDistance over the obstacles the grid was built from
+
+    // The grid as stored in a binary scenario: the bounds of cell c are cellBounds()[cellStart()[c]] to cellBounds()[cellStart()[c + 1] - 1]
+    const int* cellStart() const { return owner ? attached_cell_start : cell_start.data(); }
+    const ObstacleBounds& cellBounds() const { return cell_bounds; }
+
+    int nx = 0, ny = 0; // Number of cells along x and y
+    double cell_w = 0.0, cell_h = 0.0; // Dimensions of a cell
+
+private:
+    double x_max = 0.0, y_max = 0.0;
+    std::vector<int> cell_start; // nx * ny + 1 offsets in cell_bounds, each cell padded up to a multiple of ObstacleBounds::LANES, when not attached
+    std::shared_ptr<const void> owner; // Set while attached
+    const int* attached_cell_start = nullptr;
+    ObstacleBounds cell_bounds; // Bounds of the obstacles overlapping each cell, grouped by cell (empty rectangles for the padding)
+
+    template <class Visit>
+    void traverse(const Point& p1, const Point& p2, Visit visit) const; // Calls visit(cell, t_in, t_out) for each cell crossed by the segment, in order, until visit returns false
+};
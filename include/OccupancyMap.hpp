@@ -0,0 +1,36 @@
+/*
+Occupancy bitmap for point-in-obstacle queries: a uniform grid over the environment where each cell is free,
+fully occupied, or on the boundary of some obstacle. Free and occupied cells are answered from two bits, only the
+boundary cells keep the list of the obstacles touching them for the exact test, so a query costs the same whatever
+the number of obstacles.
+*/
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+struct Point;
+struct Obstacle; // Defined in Problem.hpp, which includes this header
+
+
+class OccupancyMap{
+public:
+    void build(const std::vector<Obstacle>& obstacles, double x_max, double y_max, double cell_size); // cell_size 0 chooses it from the number of obstacles
+    bool empty() const { return nx == 0; }
+
+    void clear();
+
+    bool contains(const Point& p, const std::vector<Obstacle>& obstacles) const; // Same result as pointInObstacles, obstacles must be those the map was built from
+
+    int nx = 0, ny = 0; // Number of cells along x and y
+    double cell_w = 0.0, cell_h = 0.0; // Dimensions of a cell
+
+private:
+    double x_max = 0.0, y_max = 0.0;
+    std::vector<uint64_t> occupied; // One bit per cell, set for the cells inside an obstacle
+    std::vector<uint64_t> boundary; // One bit per cell, set for the cells partly covered by obstacles
+    std::vector<uint32_t> boundary_rank; // Number of boundary cells before each word of boundary
+    std::vector<uint32_t> item_start; // Obstacles touching the r-th boundary cell are items[item_start[r]] to items[item_start[r + 1] - 1]
+    std::vector<uint32_t> items; // Obstacle indices
+};
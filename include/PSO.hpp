@@ -4,41 +4,148 @@
 #include <utility>
 #include <random>
 #include <functional> // To pass the fitness function as a parameter
+#include <memory>
+#include <algorithm>
 
 #include "Problem.hpp"
+#include "ThreadPool.hpp"
+#include "Random.hpp"
+#include "PathEvaluator.hpp"
 
 
-struct Particle{
-    std::vector<Point> waypoints;
-    std::vector<Point> velocity; 
-    std::vector<Point> best_waypoints;
-    double best_cost;
-    int stagnation_counter;
+/*
+Storage of the whole swarm in one contiguous arena, laid out as separate x and y arrays for the positions,
+the velocities and the personal bests. The waypoints of particle i are entries i * num_waypoints to
+(i + 1) * num_waypoints - 1 of each array, so the update loops stream through memory linearly and never allocate.
+*/
+struct Swarm{
+    int num_particles;
+    int num_waypoints;
+    std::vector<double> best_cost; // best_cost[i] is the cost of the personal best of particle i
+    std::vector<int> stagnation_counter; // Iterations since particle i last improved its personal best
 
-    Particle(const Problem& problem, int num_waypoints); 
+    Swarm(int num_particles, int num_waypoints);
+
+    double* x(int i) { return arena.data() + (0 * num_particles + i) * num_waypoints; } // Positions
+    double* y(int i) { return arena.data() + (1 * num_particles + i) * num_waypoints; }
+    double* vx(int i) { return arena.data() + (2 * num_particles + i) * num_waypoints; } // Velocities
+    double* vy(int i) { return arena.data() + (3 * num_particles + i) * num_waypoints; }
+    double* best_x(int i) { return arena.data() + (4 * num_particles + i) * num_waypoints; } // Personal bests
+    double* best_y(int i) { return arena.data() + (5 * num_particles + i) * num_waypoints; }
+    const double* x(int i) const { return arena.data() + (0 * num_particles + i) * num_waypoints; }
+    const double* y(int i) const { return arena.data() + (1 * num_particles + i) * num_waypoints; }
+    const double* best_x(int i) const { return arena.data() + (4 * num_particles + i) * num_waypoints; }
+    const double* best_y(int i) const { return arena.data() + (5 * num_particles + i) * num_waypoints; }
+
+    void randomize(int i, const Problem& problem, RandomStream& rng); // Random positions drawn from rng, zero velocity, no personal best yet
+    void saveBest(int i); // Copies the position of particle i into its personal best
+    void copyPosition(int i, std::vector<Point>& out) const; // Copies the position of particle i into out, which is only resized if needed
+    void copyBest(int i, std::vector<Point>& out) const; // Same for the personal best
+
+private:
+    std::vector<double> arena;
+};
+
+double fitness(const std::vector<Point>& waypoints, const Problem& problem);
+
+double fitness_refined(const std::vector<Point>& waypoints, const Problem& problem);
+
+using FitnessFunction = std::function<double(const std::vector<Point>&, const Problem&)>; // Type-erased fitness, for a choice made at run time
+
+// Fitness functions as compile-time policies, so that the optimizers can inline them into the evaluation loop.
+// path_cost tells local moves how to evaluate the fitness incrementally with a PathEvaluator.
+struct Fitness{
+    static constexpr PathCost path_cost = PathCost::COLLISION_PENALTY;
+    double operator()(const std::vector<Point>& waypoints, const Problem& problem) const { return fitness(waypoints, problem); }
+};
+
+struct FitnessRefined{
+    static constexpr PathCost path_cost = PathCost::PENETRATION;
+    double operator()(const std::vector<Point>& waypoints, const Problem& problem) const { return fitness_refined(waypoints, problem); }
 };
 
+// Keeps the compiler from deducing T, so that the templated optimizers are only picked with an explicit fitness type
+// and a plain function passed as fitness goes to the FitnessFunction overloads
+template <typename T>
+struct NonDeduced{
+    using type = T;
+};
+
+template <typename FitnessFn, typename Restart, typename Acceptance, typename Learning>
+class PSOEngine;
+
 class PSO{
 public:
-    std::vector<Particle> particles;
+    Swarm swarm;
     std::vector<Point> global_best_waypoints;
     double global_best_cost;
 
-    PSO(const Problem& problem, int num_particles, int num_waypoints);
+    // With num_threads > 1, particles are evaluated and moved in parallel. Runs are reproducible for a given seed, whatever the number of threads.
+    PSO(const Problem& problem, int num_particles, int num_waypoints, int num_threads = 1, uint64_t seed = masterSeed());
 
+    // The optimizers are configurations of PSOEngine (PSOEngine.hpp), which can also be used directly for other combinations of features.
+    // They are templates on the fitness, instantiated in PSO.cpp for Fitness, FitnessRefined and FitnessFunction,
+    // e.g. pso.optimize<FitnessRefined>(problem, num_iterations, c1, c2, w). Any other fitness goes through the FitnessFunction overloads.
+    template <typename FitnessFn>
     std::pair<std::vector<Point>, double> optimize(const Problem& problem, int num_iterations,
-    double c1, double c2, double w, std::function<double(const std::vector<Point>&, const Problem&)> fitness);
+    double c1, double c2, double w, const typename NonDeduced<FitnessFn>::type& fitness = FitnessFn());
 
+    template <typename FitnessFn>
     std::pair<std::vector<Point>, double> optimize_with_random_restart(const Problem& problem, int num_iterations,
-    double c1, double c2, double w, int restart_interval, std::function<double(const std::vector<Point>&, const Problem&)> fitness);
+    double c1, double c2, double w, int restart_interval, const typename NonDeduced<FitnessFn>::type& fitness = FitnessFn());
 
+    template <typename FitnessFn>
     std::pair<std::vector<Point>, double> optimize_with_annealing(const Problem& problem, int num_iterations,
-    double c1, double c2, double w, int restart_interval, double initial_temp, double cooling_rate, std::function<double(const std::vector<Point>&, const Problem&)> fitness);
+    double c1, double c2, double w, int restart_interval, double initial_temp, double cooling_rate, const typename NonDeduced<FitnessFn>::type& fitness = FitnessFn());
 
+    template <typename FitnessFn>
     std::pair<std::vector<Point>, double> optimize_with_dimensional_learning(const Problem& problem, int num_iterations,
-    double c1, double c2, double w, int restart_interval, double initial_temp, double cooling_rate, int stagnation_threshold, std::function<double(const std::vector<Point>&, const Problem&)> fitness);
-};
+    double c1, double c2, double w, int restart_interval, double initial_temp, double cooling_rate, int stagnation_threshold, const typename NonDeduced<FitnessFn>::type& fitness = FitnessFn());
 
-double fitness(const std::vector<Point>& waypoints, const Problem& problem);
+    // Type-erased versions, one indirect call per fitness evaluation
+    std::pair<std::vector<Point>, double> optimize(const Problem& problem, int num_iterations,
+    double c1, double c2, double w, FitnessFunction fitness);
+
+    std::pair<std::vector<Point>, double> optimize_with_random_restart(const Problem& problem, int num_iterations,
+    double c1, double c2, double w, int restart_interval, FitnessFunction fitness);
+
+    std::pair<std::vector<Point>, double> optimize_with_annealing(const Problem& problem, int num_iterations,
+    double c1, double c2, double w, int restart_interval, double initial_temp, double cooling_rate, FitnessFunction fitness);
+
+    std::pair<std::vector<Point>, double> optimize_with_dimensional_learning(const Problem& problem, int num_iterations,
+    double c1, double c2, double w, int restart_interval, double initial_temp, double cooling_rate, int stagnation_threshold, FitnessFunction fitness);
+
+private:
+    std::unique_ptr<ThreadPool> pool; // Workers for the parallel mode, null when running on a single thread
+    std::vector<double> costs; // costs[i] is the fitness of particle i at the current iteration
+    std::vector<double> random_coefficients; // r1 and r2 for each waypoint of each particle, drawn for the current velocity update
+    std::vector<RandomStream> particle_rngs; // particle_rngs[i] is the stream of particle i, kept across restarts
+    RandomStream rng; // Stream for the swarm-level draws (annealing acceptance)
+    std::vector<std::vector<Point>> scratch; // One waypoint buffer per thread, to pass positions to the fitness function without allocating
+
+    template <typename Body>
+    void forEachParticle(const Body& body); // Runs body(particle, thread) on every particle, in parallel when a pool is available
+    void updateParticles(const Problem& problem, double c1, double c2, double w); // Velocity and position update of every particle
+    void restartParticles(const Problem& problem); // Gives every particle a new random position, in place, and resets the global best
+
+    template <typename FitnessFn, typename Restart, typename Acceptance, typename Learning>
+    friend class PSOEngine;
+};
 
-double fitness_refined(const std::vector<Point>& waypoints, const Problem& problem);
\ No newline at end of file
+template <typename Body>
+void PSO::forEachParticle(const Body& body) {
+    if (!pool) {
+        for (int k = 0; k < swarm.num_particles; ++k) {
+            body(k, 0);
+        }
+        return;
+    }
+    // The body is only called through the pool once per chunk, and is inlined into the loop over the particles of the chunk
+    // A few chunks per thread balance the load when some particles are more expensive to process than others
+    int grain = std::max(1, swarm.num_particles / (8 * pool->size()));
+    pool->parallelFor(swarm.num_particles, grain, [&](int begin, int end, int thread) {
+        for (int k = begin; k < end; ++k) {
+            body(k, thread);
+        }
+    });
+}
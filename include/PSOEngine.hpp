@@ -0,0 +1,237 @@
+/*
+PSO engine shared by all the optimizers.
+One iteration evaluates the particles, updates the personal and global bests, and moves the particles. The variants
+(random restarts, annealing acceptance of worse global bests, dimensional learning) are strategies given as template
+parameters, so a disabled feature compiles to nothing. The engine can be run to completion with run(), or driven one
+iteration at a time with init() and step(), e.g. to interleave several swarms.
+*/
+
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+
+#include "PSO.hpp"
+#include "PathEvaluator.hpp"
+
+
+/// Restart strategies
+
+struct NoRestart{
+    bool due(int) const { return false; }
+};
+
+struct PeriodicRestart{
+    int interval; // Number of iterations after which all particles are given new random positions
+
+    bool due(int iteration) const { return iteration > 0 && iteration % interval == 0; }
+};
+
+
+/// Acceptance strategies, deciding whether a particle worse than the global best replaces it anyway
+
+struct GreedyAcceptance{
+    bool accept(double, double, RandomStream&) const { return false; }
+    void cool() {}
+};
+
+struct AnnealingAcceptance{
+    double temperature; // The larger, the more likely to accept worse solutions
+    double cooling_rate; // Factor applied to the temperature after each iteration, between 0 and 1
+
+    bool accept(double cost, double global_best_cost, RandomStream& rng) const {
+        if (cost <= global_best_cost) {
+            return false;
+        }
+        double acceptance_prob = std::min(1.0, exp(-(cost - global_best_cost) / temperature));
+        return rng.uniform() < acceptance_prob;
+    }
+    void cool() { temperature *= cooling_rate; }
+};
+
+
+/// Learning strategies
+
+struct NoLearning{
+    static constexpr bool enabled = false;
+};
+
+struct DimensionalLearning{
+    static constexpr bool enabled = true;
+    int stagnation_threshold; // Number of iterations without improvement of a personal best before the particle learns from the global best
+};
+
+
+template <typename FitnessFn, typename Restart = NoRestart, typename Acceptance = GreedyAcceptance, typename Learning = NoLearning>
+class PSOEngine{
+public:
+    PSO& pso;
+    const Problem& problem;
+    double c1, c2, w;
+    FitnessFn fitness;
+    Restart restart;
+    Acceptance acceptance;
+    Learning learning;
+    int iteration = 0; // Number of calls to step() since init()
+
+    PSOEngine(PSO& _pso, const Problem& _problem, double _c1, double _c2, double _w, FitnessFn _fitness = FitnessFn(),
+        Restart _restart = Restart(), Acceptance _acceptance = Acceptance(), Learning _learning = Learning())
+        : pso(_pso), problem(_problem), c1(_c1), c2(_c2), w(_w), fitness(_fitness), restart(_restart), acceptance(_acceptance),
+          learning(_learning) {}
+
+    void init(); // Starts a run from the current state of the swarm
+    void step(); // Runs one iteration
+    std::pair<std::vector<Point>, double> best() const; // Best path found since init(), across restarts
+
+    std::pair<std::vector<Point>, double> run(int num_iterations) {
+        init();
+        for (int iter = 0; iter < num_iterations; ++iter) {
+            step();
+        }
+        return best();
+    }
+
+private:
+    // Best path of the swarms replaced by restarts
+    std::vector<Point> final_best_waypoints;
+    double final_best_cost = 0.0;
+    std::vector<PathEvaluator> evaluators; // One per thread, for the local moves of dimensional learning when the fitness is incremental
+
+    void evaluateParticles(); // Fills pso.costs
+    void updateBests(); // Sequential reduction of the costs into the personal and global bests
+    void learnDimensions(); // Dimensional learning on the stagnated particles
+};
+
+
+template <typename FitnessFn, typename Restart, typename Acceptance, typename Learning>
+void PSOEngine<FitnessFn, Restart, Acceptance, Learning>::init() {
+    // Ensure global_best_waypoints is initialized
+    if (pso.global_best_waypoints.empty() && pso.swarm.num_particles > 0) {
+        pso.swarm.copyPosition(0, pso.global_best_waypoints);
+    }
+    final_best_waypoints = pso.global_best_waypoints;
+    final_best_cost = pso.global_best_cost;
+    iteration = 0;
+    if constexpr (Learning::enabled && IncrementalFitness<FitnessFn>::value) {
+        evaluators.assign(pso.scratch.size(), PathEvaluator(FitnessFn::path_cost));
+    }
+}
+
+template <typename FitnessFn, typename Restart, typename Acceptance, typename Learning>
+void PSOEngine<FitnessFn, Restart, Acceptance, Learning>::step() {
+    if (restart.due(iteration)) {
+        // Keep the best of the current swarm before it is replaced
+        if (final_best_cost > pso.global_best_cost) {
+            final_best_cost = pso.global_best_cost;
+            final_best_waypoints = pso.global_best_waypoints;
+        }
+        pso.restartParticles(problem);
+    }
+
+    evaluateParticles();
+    updateBests();
+
+    // Dimensional learning, once the global best of this iteration is known
+    if constexpr (Learning::enabled) {
+        learnDimensions();
+    }
+
+    // Update velocities and positions of particles
+    pso.updateParticles(problem, c1, c2, w);
+    acceptance.cool();
+    iteration++;
+}
+
+template <typename FitnessFn, typename Restart, typename Acceptance, typename Learning>
+std::pair<std::vector<Point>, double> PSOEngine<FitnessFn, Restart, Acceptance, Learning>::best() const {
+    if (final_best_cost > pso.global_best_cost) {
+        return {pso.global_best_waypoints, pso.global_best_cost};
+    }
+    return {final_best_waypoints, final_best_cost};
+}
+
+template <typename FitnessFn, typename Restart, typename Acceptance, typename Learning>
+void PSOEngine<FitnessFn, Restart, Acceptance, Learning>::evaluateParticles() {
+    // The evaluations are independent, the bests are then updated sequentially in particle order so that the result does not depend on the number of threads
+    pso.forEachParticle([&](int k, int thread) {
+        std::vector<Point>& waypoints = pso.scratch[thread];
+        pso.swarm.copyPosition(k, waypoints);
+        pso.costs[k] = fitness(waypoints, problem);
+    });
+}
+
+template <typename FitnessFn, typename Restart, typename Acceptance, typename Learning>
+void PSOEngine<FitnessFn, Restart, Acceptance, Learning>::updateBests() {
+    Swarm& swarm = pso.swarm;
+    for (int k = 0; k < swarm.num_particles; ++k) {
+        // Update particle's best known position
+        double cost = pso.costs[k];
+        if (cost < swarm.best_cost[k]) {
+            swarm.best_cost[k] = cost;
+            swarm.saveBest(k);
+            if constexpr (Learning::enabled) {
+                swarm.stagnation_counter[k] = 0; // Reset stagnation counter on improvement
+            }
+        } else if constexpr (Learning::enabled) {
+            swarm.stagnation_counter[k]++; // Increment stagnation counter if no improvement
+        }
+
+        // Update global best position
+        if (cost < pso.global_best_cost) {
+            pso.global_best_cost = cost;
+            swarm.copyPosition(k, pso.global_best_waypoints);
+        } else if (acceptance.accept(cost, pso.global_best_cost, pso.rng)) {
+            pso.global_best_cost = cost;
+            swarm.copyPosition(k, pso.global_best_waypoints);
+        }
+    }
+}
+
+template <typename FitnessFn, typename Restart, typename Acceptance, typename Learning>
+void PSOEngine<FitnessFn, Restart, Acceptance, Learning>::learnDimensions() {
+    Swarm& swarm = pso.swarm;
+    // Each particle only changes its own local best, against the global best of the iteration, so particles can learn in parallel
+    pso.forEachParticle([&](int k, int thread) {
+        // If the particle has stagnated, update its local best coordinate by coordinate
+        if (swarm.stagnation_counter[k] < learning.stagnation_threshold) {
+            return;
+        }
+        if constexpr (IncrementalFitness<FitnessFn>::value) {
+            // Only the two segments next to the modified waypoint are evaluated again
+            PathEvaluator& evaluator = evaluators[thread];
+            std::vector<Point>& best = pso.scratch[thread];
+            swarm.copyBest(k, best);
+            evaluator.evaluate(best, problem);
+            for (int j = 0; j < swarm.num_waypoints; ++j) {
+                double candidate_cost = evaluator.tryMove(j, pso.global_best_waypoints[j], problem);
+                if (candidate_cost < swarm.best_cost[k]) {
+                    evaluator.commitMove();
+                    swarm.best_cost[k] = candidate_cost;
+                    swarm.best_x(k)[j] = pso.global_best_waypoints[j].x;
+                    swarm.best_y(k)[j] = pso.global_best_waypoints[j].y;
+                }
+            }
+        } else {
+            std::vector<Point>& candidate = pso.scratch[thread];
+            swarm.copyBest(k, candidate);
+            for (int j = 0; j < swarm.num_waypoints; ++j) {
+                // Create a new candidate by replacing the j-th coordinate with the global best
+                Point candidate_waypoint = candidate[j];
+                candidate[j] = pso.global_best_waypoints[j];
+
+                double candidate_cost = fitness(candidate, problem);
+                if (candidate_cost < swarm.best_cost[k]) {
+                    swarm.best_cost[k] = candidate_cost;
+                    swarm.best_x(k)[j] = candidate[j].x;
+                    swarm.best_y(k)[j] = candidate[j].y;
+                } else {
+                    // Revert the change if it doesn't improve
+                    candidate[j] = candidate_waypoint;
+                }
+            }
+        }
+        swarm.stagnation_counter[k] = 0; // Reset stagnation counter after learning
+    });
+}
@@ -0,0 +1,62 @@
+/*
+Incremental evaluation of the PSO fitness for local moves.
+The evaluator keeps the length and the collision term of every segment of a path (start, waypoints, goal), so moving
+one waypoint only recomputes the two segments next to it. The totals are summed in the same order as fitness() and
+fitness_refined(), so an incremental cost is bit-identical to a full evaluation of the same path.
+*/
+
+#pragma once
+
+#include <vector>
+#include <type_traits>
+
+#include "Problem.hpp"
+
+
+// Constants of the fitness functions of PSO.hpp, shared with the evaluator so that its costs match theirs exactly
+const double COLLISION_PENALTY = 1e9; // Added by fitness() to the length of a colliding path
+const double PENETRATION_WEIGHT = 1e6; // Weight of the collision distance in fitness_refined()
+
+// Cost models of the fitness functions of PSO.hpp
+enum class PathCost{
+    COLLISION_PENALTY, // fitness(): length, plus a fixed penalty if any segment collides
+    PENETRATION // fitness_refined(): length, plus a weight times the distance travelled into obstacles
+};
+
+class PathEvaluator{
+public:
+    explicit PathEvaluator(PathCost model = PathCost::PENETRATION);
+
+    double evaluate(const std::vector<Point>& waypoints, const Problem& problem); // Full evaluation, which becomes the current path
+    double tryMove(int j, const Point& p, const Problem& problem); // Cost of the current path with waypoint j moved to p, the current path is left unchanged
+    void commitMove(); // Applies the last tryMove to the current path
+
+    double cost() const { return current_cost; }
+    const std::vector<Point>& waypoints() const { return points; }
+
+private:
+    PathCost model;
+    std::vector<Point> points;
+    // Segment s goes from waypoint s - 1 to waypoint s, where waypoint -1 is the start and waypoint points.size() the goal
+    std::vector<double> lengths;
+    std::vector<double> penalties; // Collision distance of each segment, or for COLLISION_PENALTY 1 if it collides, 0 if not, -1 if not tested yet
+    double current_cost = 0.0;
+
+    // Last tryMove, which replaces segments pending_j and pending_j + 1
+    int pending_j = -1;
+    Point pending_point;
+    double pending_lengths[2];
+    double pending_penalties[2];
+    double pending_cost = 0.0;
+
+    double segmentPenalty(const Point& p1, const Point& p2, const Problem& problem) const;
+    bool collides(int moved, const Problem& problem); // Whether any segment collides, testing only the segments needed to decide
+    double total(int moved, const Problem& problem); // Cost from the cached segments, with those of the pending move if moved >= 0
+};
+
+// True for fitness policies that declare their cost model with a static path_cost member, which lets local moves use a PathEvaluator
+template <typename FitnessFn, typename = void>
+struct IncrementalFitness : std::false_type{};
+
+template <typename FitnessFn>
+struct IncrementalFitness<FitnessFn, std::void_t<decltype(FitnessFn::path_cost)>> : std::true_type{};
@@ -0,0 +1,39 @@
+/*
+Space-time index of the path of the first robot, which moves along it at unit speed from its first point, so that
+the arc length at which it reaches a point is also the time at which it gets there.
+The prefix arc lengths give the time interval of every segment, and a binary search gives the segments whose
+interval meets the time window of a query. A uniform grid over the bounding box of the path lists the segments
+overlapping each cell, for when that window still holds many segments. A query thus tests only the segments that
+are both near the edge and travelled at about the same time, whatever the length of the path.
+*/
+
+#pragma once
+
+#include <vector>
+
+struct Point;
+
+
+class PathIndex{
+public:
+    void build(const std::vector<Point>& path); // Indexes the segments of path, which may have fewer than 2 points (no segment)
+    bool empty() const { return arc_length.size() < 2; }
+
+    // Whether a robot leaving p1 at time t1 towards p2 crosses the path at a point that both robots reach less than
+    // separation apart in time. Same result as testing every segment of the path.
+    bool conflicts(const Point& p1, double t1, const Point& p2, double separation) const;
+
+    int nx = 0, ny = 0; // Number of cells along x and y
+    double cell_w = 0.0, cell_h = 0.0; // Dimensions of a cell
+
+private:
+    std::vector<Point> points; // The path
+    std::vector<double> arc_length; // arc_length[i] is the length of the path up to points[i], summed in order
+    double x0 = 0.0, y0 = 0.0, x1 = 0.0, y1 = 0.0; // Bounding box of the path
+    std::vector<int> cell_start; // Segments of cell c are cell_items[cell_start[c]] to cell_items[cell_start[c + 1] - 1]
+    std::vector<int> cell_items; // Segment indices, grouped by cell. Segment i goes from points[i] to points[i + 1].
+    std::vector<int> first_cell_x, first_cell_y; // Lowest cell column and row overlapped by each segment
+
+    bool segmentConflicts(int i, const Point& p1, double t1, const Point& p2, double separation) const;
+    void cellRange(double xmin, double xmax, double ymin, double ymax, int& ix0, int& ix1, int& iy0, int& iy1) const;
+};
@@ -0,0 +1,39 @@
+/*
+Gradient-based polishing of a path found by PSO or RRT.
+The waypoints minimize a smooth cost, the length of the path plus weight times the integral along the path of
+max(0, clearance - d)^2, where d is the signed distance to the obstacles read from a DistanceField. The cost and its
+gradient with respect to every waypoint are computed analytically, and minimized with L-BFGS, every step being
+projected into the map. The refined path is returned only if it is still collision-free (exact test, leaving the map
+included) whenever the input was.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "Problem.hpp"
+#include "DistanceField.hpp"
+
+
+class PathRefiner{
+public:
+    PathRefiner(const Problem& problem, const DistanceField& field, double clearance = 10.0, double weight = 10.0);
+
+    double clearance; // Distance to the obstacles below which the path is penalized
+    double weight; // Weight of the clearance term, raised automatically if the refined path would cross an obstacle
+    int max_iterations = 200; // L-BFGS iterations
+    int history = 8; // Number of L-BFGS correction pairs
+
+    std::vector<Point> refine(const std::vector<Point>& waypoints, const Point& start, const Point& goal) const; // Polishes the waypoints of start -> waypoints -> goal (the PSO convention)
+    std::vector<Point> refinePath(const std::vector<Point>& path) const; // Polishes a full path (the RRT convention), keeping its endpoints
+
+private:
+    const Problem& problem;
+    const DistanceField& field;
+
+    // Smooth cost of start -> x -> goal, x holding the waypoint coordinates (x0, y0, x1, y1, ...), and its gradient if requested.
+    // samples[s] is the number of distance samples on segment s, fixed during a refinement so that the cost stays smooth.
+    double evaluate(const std::vector<double>& x, const Point& start, const Point& goal, const std::vector<int>& samples, double weight, std::vector<double>* gradient) const;
+    std::vector<double> minimize(std::vector<double> x, const Point& start, const Point& goal, const std::vector<int>& samples, double weight) const; // L-BFGS from x
+    bool collides(const std::vector<Point>& waypoints, const Point& start, const Point& goal) const; // Exact test of start -> waypoints -> goal, a waypoint outside the map colliding
+};
@@ -0,0 +1,39 @@
+/*
+A Problem together with everything the planners derive from it, built once and never modified afterwards, so that
+any number of planners, on any number of threads, can share it without rebuilding or locking anything.
+It owns a copy of the problem, whose collision indices (bounds, grid, occupancy bitmap) come already built by
+Problem::buildIndex, the vertex list and perimeter samples of the intelligent sampling, and the distance field of
+the refiner. The distance field is the only part built on first use, exactly once even under concurrent calls.
+*/
+
+#pragma once
+
+#include <vector>
+#include <mutex>
+
+#include "Problem.hpp"
+#include "DistanceField.hpp"
+
+
+class PreparedProblem{
+public:
+    // num_points_near_obstacles is the N of Problem::pointsNearObstacles, the value the planners are run with
+    explicit PreparedProblem(Problem problem, int num_points_near_obstacles = 1000);
+    PreparedProblem(const PreparedProblem&) = delete; // Shared by reference, never copied
+    PreparedProblem& operator=(const PreparedProblem&) = delete;
+
+    const Problem problem;
+
+    const std::vector<Point>& verticesObstacles() const { return vertices_obstacles; } // Problem::verticesObstacles
+    const std::vector<Point>& pointsNearObstacles() const { return points_near_obstacles; } // Problem::pointsNearObstacles(numPointsNearObstacles())
+    int numPointsNearObstacles() const { return num_points_near_obstacles; }
+    const DistanceField& distanceField() const; // Built with the default spacing on the first call
+
+private:
+    const int num_points_near_obstacles;
+    const std::vector<Point> vertices_obstacles;
+    const std::vector<Point> points_near_obstacles;
+
+    mutable std::once_flag field_built;
+    mutable DistanceField field;
+};
@@ -3,6 +3,9 @@
 #include <vector>
 #include <string>
 
+#include "ObstacleGrid.hpp"
+#include "OccupancyMap.hpp"
+
 
 struct Point{
     double x, y;
@@ -11,6 +14,12 @@ struct Point{
 
 struct Obstacle{Point ll_corner; double lx, ly;}; // defines a rectangular obstacle
 
+// Scenario files are either text (the values separated by whitespace) or binary: a header with the start, goal and radius
+// values, the packed obstacle array, then the padded bounds of ObstacleBounds, which are memory-mapped rather than parsed
+enum class ScenarioFormat{TEXT, BINARY};
+
+bool isBinaryScenario(const std::string& filename); // detects the format of a scenario file from its first bytes
+
 class Problem{
 public:
     double x_max, y_max; // dimensions of the environment
@@ -21,13 +30,28 @@ public:
     double radius;
 
     std::vector<Obstacle> obstacles; // list of obstacles in the environment
-
-    bool loadScenario(const std::string& filename); // loads problem data from a file
+    ObstacleBounds bounds; // structure-of-arrays copy of the obstacle bounds, built by buildIndex
+    ObstacleGrid grid; // broad-phase index over the obstacles, built by buildIndex when there are enough obstacles for it to pay off
+    OccupancyMap occupancy; // occupancy bitmap for point queries, built by buildIndex under the same condition as the grid
+    double occupancy_cell_size = 0.0; // cell size of the occupancy bitmap, 0 to choose it from the number of obstacles, negative for no bitmap
+
+    bool loadScenario(const std::string& filename); // loads problem data from a file, in either format
+    bool saveScenario(const std::string& filename, ScenarioFormat format = ScenarioFormat::TEXT) const; // writes the problem in the format read by loadScenario, in text with the shortest exact representation of every value
+    void buildIndex(); // builds the obstacle index, must be called again whenever obstacles change (loadScenario does it)
     bool isCollision(const Point& p1, const Point& p2) const; // checks if the line segment between p1 and p2 collides with any obstacles
     bool isCollision(const std::vector<Point>& path) const; // checks if a given path collides with any obstacles
+    bool isOccupied(const Point& p) const; // checks if a point lies in any obstacle, same result as pointInObstacles
+    double collisionDistance(const Point& p1, const Point& p2) const; // calculates the distance travelled into obstacles by the line segment between p1 and p2
     double collisionDistance(const std::vector<Point>& path) const; // calculates the distance travelled into obstacles for a given path
     std::vector<Point> verticesObstacles() const; // returns a vector of all the vertices of the obstacles that are not on the boundary of the environment
     std::vector<Point> pointsNearObstacles(double N) const; // returns a vector of points near obstacles. N is the approximate number of desired points.
-    
+
+private:
+    bool loadTextScenario(const std::string& filename);
+    bool loadBinaryScenario(const std::string& filename); // maps the file, the obstacle bounds are used in place
+    bool saveBinaryScenario(const std::string& filename) const;
+    bool checkEnvironment() const; // checks the dimensions, radius, starts and goals, reports errors on std::cerr
+    void buildGrid(); // second half of buildIndex once the bounds are set: the grid and the occupancy bitmap
+    void buildOccupancy(); // the occupancy bitmap alone, for a grid loaded from a binary file
 };
 
@@ -2,16 +2,53 @@
 
 #include <vector>
 #include <string>
+#include <tuple>
+#include <utility>
+#include <unordered_set>
+#include <cstdint>
+#include <functional>
 
 #include "Problem.hpp"
+#include "KDTree.hpp"
+#include "Random.hpp"
+#include "Sampler.hpp"
+#include "PreparedProblem.hpp"
+#include "PathIndex.hpp"
 
 
+enum class PlannerMode{
+    RRT_STAR, // One tree from the start, rewired, which reaches the goal once a vertex lands within delta_s of it
+    CONNECT, // RRT-Connect: trees from the start and from the goal, each extended greedily towards the other, for a fast first path
+    INFORMED // Anytime Informed RRT*: keeps improving the path until the budget runs out, sampling only where it can get shorter
+};
+
 struct Tree{
     std::vector<Point> vertices;
     std::vector<int> parents; // parents[i] gives the index of the parent of vertices[i]
-    std::vector<double> costs; // costs[i] gives the cost from the root to vertices[i]
+    std::vector<double> costs; // costs[i] gives the cost from the root to vertices[i], kept exact through the rewirings
+    // Children of every vertex, as doubly linked lists threaded through flat arrays indexed like vertices (no allocation per vertex)
+    std::vector<int> first_child; // first_child[i] is one of the children of vertices[i], -1 if it has none
+    std::vector<int> next_sibling, prev_sibling; // Neighbors of vertices[i] in the list of children of its parent, -1 at the ends
+    KDTree index; // Spatial index over vertices, used for nearest-neighbor and radius queries
 
     Tree(Point root); // Initializes the tree with the start point
+
+    int add(const Point& vertex, int parent); // Appends vertex as a child of parent, returns its index
+    int reparent(int i, int parent); // Makes parent the parent of vertex i and updates the costs of the subtree of i, returns its size
+    void rebuildChildren(); // Rebuilds the children lists from parents, and the costs from the roots, after parents was written directly
+
+private:
+    std::vector<int> subtree_stack; // Reused by the traversals of reparent and rebuildChildren
+    void link(int i, int parent);
+    void unlink(int i);
+    int updateSubtreeCosts(int i); // Costs of the descendants of i from the cost of i, returns the size of the subtree
+};
+
+struct EdgeCacheStats{
+    long long queries = 0; // Edge validity tests made by RRT*
+    long long hits = 0; // Answered by the cache of the current iteration, the edge having been tested already
+    long long bad_edge_hits = 0; // Answered by the cross-iteration cache of blocked edges
+    double hitRate() const { return queries ? double(hits + bad_edge_hits) / queries : 0.0; }
 };
 
 class RRT{
@@ -19,16 +56,61 @@ public:
     Tree tree;
     Tree tree2; // For the second robot in the two-robot case
 
-    RRT(const Problem& problem);
+    mutable RandomStream rng; // Stream of the samplers, mutable since sampling does not change the trees
+    int num_threads = 1; // Threads growing the tree in buildRRT, 1 for the sequential RRT*
+    PlannerMode mode = PlannerMode::RRT_STAR; // Planner run by rrtPath
+    double p_goal = 0.0; // Probability of sampling the goal itself (goal bias)
+    bool quasi_random = false; // Whether the uniform part of the sampling follows a Halton sequence rather than independent draws
+    bool lazy_collision = false; // Whether RRT* checks the candidate parents of a new vertex by increasing cost, stopping at the first collision-free one, rather than all of them
+    bool cache_bad_edges = false; // Whether RRT* remembers the blocked edges across iterations, worth it when the samples repeat (intelligent sampling)
+    EdgeCacheStats edge_cache_stats; // Counters of the edge validity cache
+    double time_budget = 0.0; // Seconds after which the INFORMED planner stops, 0 to run all its iterations
+    std::function<void(const std::vector<Point>& path, double cost, int iterations)> on_solution; // Called by the INFORMED planner on each better path (points between start and goal, as returned by rrtPath)
+
+    RRT(const Problem& problem, uint64_t seed = masterSeed());
     
     void addVertex(const Point& vertex, int parent_index, bool is_second_robot=false    ); // Adds a vertex to the tree with the given parent index
     std::vector<Point> reconstructPath(int vertex_index, bool is_second_robot=false) const; // Reconstructs the path from the root to the given vertex index
     Point randomSample_naive(const Problem& problem) const; // Samples a random point uniformly in the environment
-    Point randomSample_intelligent(const Problem& problem, std::vector<Point> verticesObstacles, double p_vertex_obstacle, std::vector<Point> pointsNearObstacles, double p_edge_obstacle) const; // Samples a random point with intelligent method proposed in question 21
-    bool edgeCollisionPath(const Problem& problem, const Point& p1, const double cost1, const Point& p2, const std::vector<Point>& path) const; // Checks if the edge between p1 and p2 intersects with any segment of the path
+    Point randomSample_intelligent(const Problem& problem, const std::vector<Point>& verticesObstacles, double p_vertex_obstacle, const std::vector<Point>& pointsNearObstacles, double p_edge_obstacle) const; // Samples a random point with intelligent method proposed in question 21
+    bool edgeCollisionPath(const Problem& problem, const Point& p1, const double cost1, const Point& p2, const PathIndex& path) const; // Checks if the edge between p1 and p2, left at time cost1, crosses the indexed path less than 2 radii apart in time
     int buildRRT(const Problem& problem, double delta_s, double delta_r, int max_iterations, bool use_intelligent_sampling=false, double p_vertex_obstacle=0.2, double p_edge_obstacle=0.3, int num_points_near_obstacles=1000, bool is_second_robot=false, std::vector<Point> path_first_robot={}); // Builds the RRT, returns the number of iterations taken to build the tree
     std::tuple<std::vector<Point>, int, double> rrtPath(const Problem& problem, double delta_s, double delta_r, int max_iterations, bool use_intelligent_sampling=false, double p_vertex_obstacle=0.2, double p_edge_obstacle=0.3, int num_points_near_obstacles=1000, bool is_second_robot=false, std::vector<Point> path_first_robot={}); // Builds the RRT and returns the path from start to goal, the number of iterations taken, and the cost of the path
     std::tuple<std::vector<Point>, double> optimizePath(const Problem& problem, std::vector<Point> path); // Optimizes the given path by removing unnecessary intermediate nodes, returns the optimized path and its cost
     std::tuple<std::vector<Point>, std::vector<Point>> rrtPath2Robots(const Problem& problem, double delta_s, double delta_r, int max_iterations, bool use_intelligent_sampling=false, double p_vertex_obstacle=0.2, double p_edge_obstacle=0.3, int num_points_near_obstacles=1000); // Builds the RRT for two robots and returns the paths for both robots
+    // Same planners on a prepared problem, which is their only input: its problem and its point sets (N being prepared.numPointsNearObstacles()) are used as they are
+    std::tuple<std::vector<Point>, int, double> rrtPath(const PreparedProblem& prepared, double delta_s, double delta_r, int max_iterations, bool use_intelligent_sampling=false, double p_vertex_obstacle=0.2, double p_edge_obstacle=0.3, bool is_second_robot=false, std::vector<Point> path_first_robot={});
+    std::tuple<std::vector<Point>, std::vector<Point>> rrtPath2Robots(const PreparedProblem& prepared, double delta_s, double delta_r, int max_iterations, bool use_intelligent_sampling=false, double p_vertex_obstacle=0.2, double p_edge_obstacle=0.3);
+
+private:
+    const PreparedProblem* prepared = nullptr; // Problem planned on by the PreparedProblem overloads, set only for the duration of their call
+    // Sampler of the planners: the mixture of the intelligent sampling parameters, p_goal and quasi_random. It draws from the point sets
+    // of prepared when set (problem and num_points_near_obstacles are then its own), else from those computed into the two buffers.
+    Sampler makeSampler(const Problem& problem, bool is_second_robot, bool use_intelligent_sampling, double p_vertex_obstacle, double p_edge_obstacle, int num_points_near_obstacles, std::vector<Point>& verticesObstacles, std::vector<Point>& pointsNearObstacles) const;
+    std::vector<std::pair<double, int>> parent_candidates; // (cost through the vertex, vertex) pairs, reused by the lazy choose-parent
+
+    // Validity of the edges from the vertices of the tree to the new vertex of an RRT* iteration, by vertex index
+    enum EdgeState : int8_t { EDGE_UNKNOWN, EDGE_FREE, EDGE_BLOCKED };
+    std::vector<int8_t> edge_state;
+    std::vector<int> edge_touched; // Vertices whose edge_state is to be reset at the end of the iteration
+    struct BadEdge{
+        int vertex; // Index in the tree
+        double x, y; // Other end, not (yet) a vertex
+        bool operator==(const BadEdge& e) const { return vertex == e.vertex && x == e.x && y == e.y; }
+    };
+    struct BadEdgeHash{
+        size_t operator()(const BadEdge& e) const { return std::hash<double>()(e.x) * 31 + std::hash<double>()(e.y) * 17 + e.vertex; }
+    };
+    std::unordered_set<BadEdge, BadEdgeHash> bad_edges[2]; // Blocked edges of tree and tree2, kept as long as the trees (tree2: as long as the path of the first robot)
+
+    // One RRT* step towards vr: steer, choose the parent among the neighbors, insert, and rewire the neighbors (first robot only).
+    // Returns the index of the new vertex, or -1 if no collision-free parent was found. Sets *rewired if a neighbor changed parent.
+    int extendRRTStar(const Problem& problem, const Point& vr, double delta_s, double delta_r, bool is_second_robot, const PathIndex& path_first_robot, std::vector<int>& neighbors, bool* rewired = nullptr);
+    // Anytime Informed RRT* (see RRT.cpp). The goal is added as the last vertex once the budget is spent.
+    int buildInformed(const Problem& problem, double delta_s, double delta_r, int max_iterations, bool use_intelligent_sampling, double p_vertex_obstacle, double p_edge_obstacle, int num_points_near_obstacles, bool is_second_robot, const PathIndex& path_first_robot);
+    // RRT-Connect from the start (tree or tree2) and from the goal. On success the branch of the goal tree is grafted
+    // onto the start tree, so that the goal is its last vertex as with buildRRT. Returns the number of iterations taken.
+    int buildConnect(const Problem& problem, double delta_s, int max_iterations, bool use_intelligent_sampling, double p_vertex_obstacle, double p_edge_obstacle, int num_points_near_obstacles, bool is_second_robot, const PathIndex& path_first_robot);
+    // buildRRT with num_threads threads sampling, checking and inserting vertices concurrently (see RRT.cpp)
+    int buildRRTParallel(const Problem& problem, double delta_s, double delta_r, int max_iterations, bool use_intelligent_sampling, double p_vertex_obstacle, double p_edge_obstacle, int num_points_near_obstacles, bool is_second_robot, const PathIndex& path_first_robot);
 };
-    
\ No newline at end of file
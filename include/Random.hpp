@@ -0,0 +1,48 @@
+/*
+Seedable random number streams.
+The generator is Philox4x32-10, a counter-based generator: the n-th block of a stream is a keyed bijection of
+(stream id, n), so any number of streams can be derived from one master seed without any shared state, and every
+particle, thread or planner can draw from its own stream independently of the others.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+
+// Stream domains, so that two planners built from the same seed do not draw the same numbers
+enum class StreamDomain : uint32_t{
+    PSO_PARTICLE = 1, // One stream per particle
+    PSO = 2, // Swarm-level decisions (annealing acceptance)
+    RRT = 3,
+    PSO_ISLAND = 4, // Seeds of the islands of a MultiSwarm
+    SCENARIO = 5, // Scenario generator, one stream per layout
+    USER = 100 // First domain free for other uses (tools, benchmarks)
+};
+
+uint64_t streamId(StreamDomain domain, uint32_t index); // Packs a domain and an index into a stream id
+
+uint64_t masterSeed(); // Seed used by planners that are not given one explicitly, 0 unless setMasterSeed was called
+void setMasterSeed(uint64_t seed);
+
+
+class RandomStream{
+public:
+    RandomStream(uint64_t seed = 0, uint64_t stream = 0);
+
+    uint64_t nextU64();
+    double uniform() { return (nextU64() >> 11) * 0x1.0p-53; } // Uniform in [0, 1), 53 random bits
+    double uniform(double a, double b) { return a + (b - a) * uniform(); } // Uniform in [a, b)
+    std::size_t uniformIndex(std::size_t n) { return static_cast<std::size_t>(uniform() * n); } // Uniform in [0, n), n > 0
+    void fillUniform(double* out, std::size_t n); // Fills out with n uniforms in [0, 1), same values as n calls to uniform()
+
+private:
+    uint32_t key[2];
+    uint64_t stream;
+    uint64_t counter = 0; // Index of the next block
+    uint32_t block[4]; // Output of the current block
+    int used = 4; // Number of 32-bit words of block already consumed
+
+    void refill();
+};
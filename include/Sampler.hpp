@@ -0,0 +1,57 @@
+/*
+Sampling of the states tried by the RRT planners, as a mixture of strategies: uniform in the environment, a
+low-discrepancy Halton sequence, a vertex of an obstacle, a point near the edges of the obstacles, or the goal.
+The strategy of each sample is drawn in constant time from an alias table (Vose), whatever the number of
+strategies, and samples are generated by batches ahead of the planner loop.
+A Sampler only refers to the point sets it draws from, which the caller builds once and keeps alive, so that it is
+cheap to copy: each thread of a planner takes its own copy, with its own batch and Halton position.
+*/
+
+#pragma once
+
+#include <vector>
+#include <utility>
+
+#include "Problem.hpp"
+#include "Random.hpp"
+
+
+enum class SamplingStrategy{
+    UNIFORM, // Uniform in the environment
+    HALTON, // Halton sequence in bases 2 and 3, shifted by a random offset so that runs with different seeds differ
+    OBSTACLE_VERTICES, // One of the vertices of the obstacles
+    OBSTACLE_EDGES, // One of the points near the edges of the obstacles
+    GOAL // The goal itself
+};
+
+class Sampler{
+public:
+    // obstacle_vertices and edge_points are those of Problem::verticesObstacles and Problem::pointsNearObstacles (or of a PreparedProblem), and must outlive the sampler
+    Sampler(const Problem& problem, const Point& goal, const std::vector<Point>& obstacle_vertices, const std::vector<Point>& edge_points);
+
+    void setWeights(const std::vector<std::pair<SamplingStrategy, double>>& weights); // Mixture to sample, normalized. Strategies with nothing to draw from are left out.
+
+    Point sample(RandomStream& stream); // One sample of the mixture
+    void sampleBatch(RandomStream& stream, std::vector<Point>& batch); // Fills the whole batch
+    Point next(RandomStream& stream); // Next sample of the internal batch, refilled with BATCH_SIZE samples when exhausted
+    void discardBatch() { batch_next = batch.size(); } // Drops the samples drawn ahead, after a change of the mixture
+
+private:
+    double x_max, y_max;
+    Point goal;
+    const std::vector<Point>* obstacle_vertices;
+    const std::vector<Point>* edge_points;
+
+    // Alias table: the column is drawn uniformly, then its own strategy with probability threshold, its alias otherwise
+    std::vector<SamplingStrategy> strategies;
+    std::vector<double> threshold;
+    std::vector<int> alias;
+
+    long long halton_index = -1; // Position in the Halton sequence, -1 until the random offset is drawn
+    double halton_shift_x = 0.0, halton_shift_y = 0.0;
+
+    std::vector<Point> batch;
+    size_t batch_next = 0;
+
+    Point draw(SamplingStrategy strategy, RandomStream& stream);
+};
@@ -0,0 +1,33 @@
+/*
+Synthetic scenarios for scaling tests, from a few obstacles to millions, in several layouts.
+Every generated scenario is valid for Problem::loadScenario, and both robots have a collision-free path from their start
+to their goal, with at least the requested clearance around it: the layouts are built around such paths.
+*/
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+#include "Problem.hpp"
+
+
+enum class ScenarioLayout{
+    CLUTTER, // Rectangles of random sizes and positions, kept off a random corridor per robot
+    WAREHOUSE, // Columns of shelves split into pallets, separated by aisles, with cross aisles along the borders
+    MAZE, // Perfect maze on a grid of cells, one obstacle per wall
+    NARROW_PASSAGES // Walls across the map, each with a single narrow gap, made of stacked blocks
+};
+
+struct ScenarioSpec{
+    ScenarioLayout layout = ScenarioLayout::CLUTTER;
+    double width = 1000.0;
+    double height = 1000.0;
+    int num_obstacles = 100; // Exact for CLUTTER, approximate for the other layouts, whose structure sets the count
+    double radius = 10.0; // Radius written to the scenario
+    double clearance = 10.0; // Free distance kept around the guaranteed paths, and half the width of the narrow passages
+    uint64_t seed = 0;
+};
+
+bool parseLayout(const std::string& name, ScenarioLayout& layout); // "clutter", "warehouse", "maze" or "narrow"
+bool generateScenario(const ScenarioSpec& spec, Problem& problem); // Replaces the content of problem, and builds its index. Reports errors on std::cerr
@@ -0,0 +1,48 @@
+/*
+Persistent pool of worker threads running parallel loops.
+The workers are started once and sleep between loops, so a parallel loop costs a wake-up rather than thread creations.
+*/
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+
+class ThreadPool{
+public:
+    explicit ThreadPool(int num_threads); // num_threads counts the calling thread, which takes part in the loops
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return num_threads; }
+
+    // Runs body(begin, end, thread) over chunks of [0, n) of at most grain iterations, and returns once all of them are done.
+    // thread is in [0, size()) and identifies the thread running the chunk, e.g. to index per-thread scratch buffers.
+    void parallelFor(int n, int grain, const std::function<void(int, int, int)>& body);
+
+private:
+    int num_threads;
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wake; // Signals a new loop (or the shutdown) to the workers
+    std::condition_variable done; // Signals the end of the loop to the caller
+    long generation = 0; // Incremented for each loop, so workers can tell a new loop from a spurious wake-up
+    int active_workers = 0; // Workers that have not finished the current loop yet
+    bool stopping = false;
+
+    // Current loop
+    const std::function<void(int, int, int)>* job = nullptr;
+    int job_size = 0;
+    int job_grain = 1;
+    std::atomic<int> next_chunk{0};
+
+    void workerLoop(int thread);
+    void runChunks(int thread); // Takes chunks of the current loop until there is none left
+};
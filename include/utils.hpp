@@ -6,6 +6,7 @@ Geometric utilities.
 
 #include "Problem.hpp"
 #include <vector>
+#include <tuple>
 
 double euclideanDistance(const Point& p1, const Point& p2);
 
@@ -16,7 +17,7 @@ bool segmentsIntersect(const Point& p1, const Point& p2, const Point& p3, const
 bool segmentIntersectsObstacle(const Point& p1, const Point& p2, const Obstacle& obs);
 bool segmentIntersectsObstacles(const Point& p1, const Point& p2, const std::vector<Obstacle>& obstacles);
 
-double segmentCollisionDistance(const Point& p1, const Point& p2, const Obstacle& obs);
+double segmentCollisionDistance(const Point& p1, const Point& p2, const Obstacle& obs, double t_start = 0.0, double t_end = 1.0); // Only the part of the segment with parameter in [t_start, t_end] is considered
 double segmentCollisionDistance(const Point& p1, const Point& p2, const std::vector<Obstacle>& obstacles);
 
 bool pointOnBoundary(const Point& p, double x_max, double y_max);
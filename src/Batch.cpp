@@ -0,0 +1,415 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+#include <memory>
+#include <map>
+#include <stdexcept>
+
+#include "Batch.hpp"
+#include "Problem.hpp"
+#include "PreparedProblem.hpp"
+#include "PSO.hpp"
+#include "MultiSwarm.hpp"
+#include "RRT.hpp"
+#include "PathRefiner.hpp"
+#include "ThreadPool.hpp"
+#include "utils.hpp"
+
+// CONSTANTS
+const std::vector<std::string> ALGORITHMS = {"pso", "pso_restart", "pso_annealing", "pso_dimensional", "pso_islands", "rrt", "rrt_optimized", "rrt_connect", "rrt_informed"};
+// Hyperparameters and their default values, the same as in main.cpp
+const std::vector<std::pair<std::string, std::string>> HYPERPARAMETERS = {
+    {"max_iterations", ""}, // PSO iterations, or maximum RRT iterations, defaults below
+    {"particles", "500"}, {"waypoints", "5"}, {"c1", "2.0"}, {"c2", "2.0"}, {"w", "0.75"},
+    {"restart_interval", "5000"}, {"temperature", "100.0"}, {"cooling_rate", "0.99"}, {"stagnation_threshold", "15"},
+    {"fitness", "refined"}, // refined or basic
+    {"islands", "4"}, {"migration_interval", "500"}, {"migrants", "10"},
+    {"topology", "ring"}, // ring or full
+    {"delta_s", "100.0"}, {"delta_r", "100.0"}, {"intelligent_sampling", "1"}, {"p_vertex_obstacle", "0.4"},
+    {"p_edge_obstacle", "0.3"}, {"points_near_obstacles", "1000"},
+    {"rrt_threads", "1"}, // Threads growing the RRT tree, runs with more than 1 are not reproducible
+    {"goal_bias", "0.0"}, {"quasi_random", "0"}, // RRT sampling: probability of the goal, 1 for a Halton sequence instead of uniform draws
+    {"lazy_collision", "0"}, // 1 for the lazy choose-parent of RRT*, which builds the same tree with fewer collision checks
+    {"cache_bad_edges", "0"}, // 1 to remember the blocked edges across RRT* iterations
+    {"time_budget", "0"}, // Seconds after which rrt_informed stops improving its path, 0 to run all its iterations
+    {"refine", "0"}, // 1 to polish the path found with the gradient-based refiner, included in the wall time
+    {"refine_clearance", "10.0"}, {"refine_weight", "10.0"}
+};
+const int PSO_MAX_ITERATIONS = 30000;
+const int RRT_MAX_ITERATIONS = 10000;
+const uint64_t MAX_SEEDS = 1000000; // Seeds a manifest may list in total, ranges included
+
+static bool isNumber(const std::string& s) {
+    std::istringstream in(s);
+    double x;
+    return (in >> x) && (in >> std::ws).eof();
+}
+
+static bool isSeed(const std::string& s) { // Digits only, since std::stoull would accept a sign (wrapping -1 to 2^64 - 1) or trailing characters
+    return !s.empty() && s.find_first_not_of("0123456789") == std::string::npos;
+}
+
+bool BatchManifest::load(const std::string& filename) {
+    std::ifstream inputFile(filename);
+    if (!inputFile.is_open()) {
+        std::cerr << "Error: Could not open manifest " << filename << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int line_number = 0;
+    while (std::getline(inputFile, line)) {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+        std::istringstream in(line);
+        std::string key, value;
+        if (!(in >> key)) {
+            continue; // Blank line or comment
+        }
+        std::vector<std::string> values;
+        while (in >> value) {
+            values.push_back(value);
+        }
+        if (values.empty()) {
+            std::cerr << "Error: No value for " << key << " at line " << line_number << " of " << filename << std::endl;
+            return false;
+        }
+
+        if (key == "scenarios") {
+            scenarios.insert(scenarios.end(), values.begin(), values.end());
+        } else if (key == "seeds") {
+            for (const auto& v : values) {
+                size_t colon = v.find(':');
+                std::string first_text = v.substr(0, colon), last_text = colon == std::string::npos ? first_text : v.substr(colon + 1);
+                try {
+                    if (!isSeed(first_text) || !isSeed(last_text)) {
+                        throw std::invalid_argument(v);
+                    }
+                    uint64_t first = std::stoull(first_text);
+                    uint64_t last = std::stoull(last_text);
+                    if (first > last) {
+                        std::cerr << "Error: Empty seed range " << v << " at line " << line_number << " of " << filename << std::endl;
+                        return false;
+                    }
+                    if (last - first >= MAX_SEEDS - seeds.size()) {
+                        std::cerr << "Error: More than " << MAX_SEEDS << " seeds at line " << line_number << " of " << filename << std::endl;
+                        return false;
+                    }
+                    for (uint64_t seed = first; seed != last; ++seed) {
+                        seeds.push_back(seed);
+                    }
+                    seeds.push_back(last); // Pushed apart so that a range ending at the largest seed does not wrap around
+                } catch (const std::exception&) {
+                    std::cerr << "Error: Invalid seed " << v << " at line " << line_number << " of " << filename << std::endl;
+                    return false;
+                }
+            }
+        } else if (key == "algorithms") {
+            for (const auto& v : values) {
+                if (std::find(ALGORITHMS.begin(), ALGORITHMS.end(), v) == ALGORITHMS.end()) {
+                    std::cerr << "Error: Unknown algorithm " << v << " at line " << line_number << " of " << filename << std::endl;
+                    return false;
+                }
+                algorithms.push_back(v);
+            }
+        } else if (key == "output") {
+            output = values[0];
+        } else if (key == "format") {
+            format = values[0];
+            if (format != "csv" && format != "json") {
+                std::cerr << "Error: Unknown format " << format << " (csv or json) at line " << line_number << std::endl;
+                return false;
+            }
+        } else if (key == "threads") {
+            num_threads = isNumber(values[0]) ? std::stoi(values[0]) : -1;
+            if (num_threads < 0) {
+                std::cerr << "Error: Invalid number of threads at line " << line_number << std::endl;
+                return false;
+            }
+        } else {
+            auto known = std::find_if(HYPERPARAMETERS.begin(), HYPERPARAMETERS.end(), [&](const auto& h) { return h.first == key; });
+            if (known == HYPERPARAMETERS.end()) {
+                std::cerr << "Error: Unknown setting " << key << " at line " << line_number << " of " << filename << std::endl;
+                return false;
+            }
+            for (const auto& v : values) {
+                bool valid = key == "fitness" ? (v == "refined" || v == "basic")
+                           : key == "topology" ? (v == "ring" || v == "full")
+                           : isNumber(v);
+                if (!valid) {
+                    std::cerr << "Error: Invalid value " << v << " for " << key << " at line " << line_number << std::endl;
+                    return false;
+                }
+            }
+            sweeps.emplace_back(key, values);
+        }
+    }
+
+    if (scenarios.empty() || algorithms.empty()) {
+        std::cerr << "Error: The manifest must list at least one scenario and one algorithm" << std::endl;
+        return false;
+    }
+    if (seeds.empty()) {
+        seeds.push_back(masterSeed());
+    }
+    return true;
+}
+
+std::vector<BatchJob> BatchManifest::jobs() const {
+    // Mixed-radix enumeration: scenario, algorithm, then each hyperparameter, and the seed varies fastest
+    std::vector<size_t> sizes = {scenarios.size(), algorithms.size()};
+    for (const auto& sweep : sweeps) {
+        sizes.push_back(sweep.second.size());
+    }
+    sizes.push_back(seeds.size());
+
+    size_t num_jobs = 1;
+    for (size_t size : sizes) {
+        num_jobs *= size;
+    }
+
+    std::vector<BatchJob> result(num_jobs);
+    std::vector<size_t> digits(sizes.size(), 0);
+    for (size_t id = 0; id < num_jobs; ++id) {
+        BatchJob& job = result[id];
+        job.id = id;
+        job.scenario = digits[0];
+        job.algorithm = algorithms[digits[1]];
+        for (size_t i = 0; i < sweeps.size(); ++i) {
+            job.values.push_back(sweeps[i].second[digits[2 + i]]);
+        }
+        job.seed = seeds[digits.back()];
+
+        for (int d = sizes.size() - 1; d >= 0; --d) {
+            if (++digits[d] < sizes[d]) {
+                break;
+            }
+            digits[d] = 0;
+        }
+    }
+    return result;
+}
+
+std::string BatchManifest::value(const BatchJob& job, const std::string& key, const std::string& fallback) const {
+    for (size_t i = 0; i < sweeps.size(); ++i) {
+        if (sweeps[i].first == key) {
+            return job.values[i];
+        }
+    }
+    for (const auto& h : HYPERPARAMETERS) {
+        if (h.first == key && !h.second.empty()) {
+            return h.second;
+        }
+    }
+    return fallback;
+}
+
+template <typename FitnessFn>
+static std::pair<std::vector<Point>, double> runPSO(const Problem& problem, const BatchManifest& manifest, const BatchJob& job, int num_iterations) {
+    auto number = [&](const std::string& key) { return std::stod(manifest.value(job, key, "0")); };
+    int num_particles = number("particles");
+    int num_waypoints = number("waypoints");
+    double c1 = number("c1"), c2 = number("c2"), w = number("w");
+
+    if (job.algorithm == "pso_islands") {
+        int num_islands = std::max(1, static_cast<int>(number("islands")));
+        MultiSwarm islands(problem, num_islands, std::max(1, num_particles / num_islands), num_waypoints, job.seed);
+        MigrationTopology topology = manifest.value(job, "topology", "ring") == "full" ? MigrationTopology::FULLY_CONNECTED : MigrationTopology::RING;
+        return islands.optimize<FitnessFn>(problem, num_iterations, c1, c2, w, number("migration_interval"), number("migrants"), topology);
+    }
+
+    PSO pso(problem, num_particles, num_waypoints, 1, job.seed); // The jobs run in parallel, each on a single thread
+    if (job.algorithm == "pso") {
+        return pso.optimize<FitnessFn>(problem, num_iterations, c1, c2, w);
+    }
+    if (job.algorithm == "pso_restart") {
+        return pso.optimize_with_random_restart<FitnessFn>(problem, num_iterations, c1, c2, w, number("restart_interval"));
+    }
+    if (job.algorithm == "pso_annealing") {
+        return pso.optimize_with_annealing<FitnessFn>(problem, num_iterations, c1, c2, w, number("restart_interval"),
+            number("temperature"), number("cooling_rate"));
+    }
+    return pso.optimize_with_dimensional_learning<FitnessFn>(problem, num_iterations, c1, c2, w, number("restart_interval"),
+        number("temperature"), number("cooling_rate"), number("stagnation_threshold"));
+}
+
+static BatchResult runJob(const PreparedProblem& prepared, const BatchManifest& manifest, const BatchJob& job) {
+    auto number = [&](const std::string& key) { return std::stod(manifest.value(job, key, "0")); };
+    const Problem& problem = prepared.problem;
+    BatchResult result;
+    auto start_time = std::chrono::steady_clock::now();
+    // Only made when refining, the distance field being built by the first job that needs it
+    auto refiner = [&]() { return PathRefiner(problem, prepared.distanceField(), number("refine_clearance"), number("refine_weight")); };
+    bool refine = number("refine") != 0;
+
+    if (job.algorithm.compare(0, 3, "pso") == 0) {
+        int num_iterations = std::stoi(manifest.value(job, "max_iterations", std::to_string(PSO_MAX_ITERATIONS)));
+        bool basic = manifest.value(job, "fitness", "refined") == "basic";
+        auto [path, cost] = basic
+            ? runPSO<Fitness>(problem, manifest, job, num_iterations)
+            : runPSO<FitnessRefined>(problem, manifest, job, num_iterations);
+        if (refine && !path.empty()) {
+            path = refiner().refine(path, problem.start1, problem.goal1);
+            cost = basic ? fitness(path, problem) : fitness_refined(path, problem);
+        }
+        result.cost = cost;
+        result.iterations = num_iterations;
+        result.success = !path.empty() && !problem.isCollision(path);
+    } else {
+        int max_iterations = std::stoi(manifest.value(job, "max_iterations", std::to_string(RRT_MAX_ITERATIONS)));
+        RRT rrt(problem, job.seed);
+        rrt.num_threads = std::max(1, static_cast<int>(number("rrt_threads")));
+        rrt.mode = job.algorithm == "rrt_connect" ? PlannerMode::CONNECT
+                 : job.algorithm == "rrt_informed" ? PlannerMode::INFORMED : PlannerMode::RRT_STAR;
+        rrt.time_budget = number("time_budget");
+        rrt.p_goal = number("goal_bias");
+        rrt.quasi_random = number("quasi_random") != 0;
+        rrt.lazy_collision = number("lazy_collision") != 0;
+        rrt.cache_bad_edges = number("cache_bad_edges") != 0;
+        auto [path, iterations, cost] = rrt.rrtPath(prepared, number("delta_s"), number("delta_r"), max_iterations,
+            number("intelligent_sampling") != 0, number("p_vertex_obstacle"), number("p_edge_obstacle")); // Prepared with the job's points_near_obstacles
+        // The goal is the last vertex of the tree once reached, the path returned lists only the points in between
+        const Point& last = rrt.tree.vertices.back();
+        result.success = last.x == problem.goal1.x && last.y == problem.goal1.y;
+        if (result.success) {
+            path.insert(path.begin(), problem.start1);
+            path.push_back(problem.goal1);
+        }
+        if (result.success && job.algorithm == "rrt_optimized") {
+            std::tie(path, cost) = rrt.optimizePath(problem, path);
+        }
+        if (result.success && refine) {
+            path = refiner().refinePath(path);
+            cost = 0.0;
+            for (size_t i = 1; i < path.size(); ++i) {
+                cost += euclideanDistance(path[i - 1], path[i]);
+            }
+        }
+        result.cost = cost;
+        result.iterations = iterations;
+    }
+
+    result.wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    return result;
+}
+
+static std::string csvHeader(const BatchManifest& manifest) {
+    std::ostringstream out;
+    out << "job,scenario,algorithm,seed";
+    for (const auto& sweep : manifest.sweeps) {
+        out << "," << sweep.first;
+    }
+    out << ",cost,iterations,wall_time,success\n";
+    return out.str();
+}
+
+// s as a JSON string literal, quotes included
+static std::string jsonString(const std::string& s) {
+    std::ostringstream out;
+    out << '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+    return out.str();
+}
+
+static std::string formatRow(const BatchManifest& manifest, const BatchJob& job, const BatchResult& result) {
+    std::ostringstream out;
+    out << std::setprecision(12);
+    if (manifest.format == "csv") {
+        out << job.id << "," << manifest.scenarios[job.scenario] << "," << job.algorithm << "," << job.seed;
+        for (const auto& v : job.values) {
+            out << "," << v;
+        }
+        out << "," << result.cost << "," << result.iterations << "," << result.wall_time << "," << (result.success ? 1 : 0) << "\n";
+        return out.str();
+    }
+
+    // One JSON object per line, numbers unquoted
+    out << "{\"job\":" << job.id << ",\"scenario\":" << jsonString(manifest.scenarios[job.scenario]) << ",\"algorithm\":" << jsonString(job.algorithm)
+        << ",\"seed\":" << job.seed;
+    for (size_t i = 0; i < job.values.size(); ++i) {
+        const std::string& v = job.values[i];
+        out << "," << jsonString(manifest.sweeps[i].first) << ":" << (isNumber(v) ? v : jsonString(v));
+    }
+    out << ",\"cost\":" << result.cost << ",\"iterations\":" << result.iterations << ",\"wall_time\":" << result.wall_time
+        << ",\"success\":" << (result.success ? "true" : "false") << "}\n";
+    return out.str();
+}
+
+int runBatch(const std::string& manifest_file) {
+    BatchManifest manifest;
+    if (!manifest.load(manifest_file)) {
+        return 1;
+    }
+
+    std::vector<Problem> loaded(manifest.scenarios.size());
+    for (size_t i = 0; i < manifest.scenarios.size(); ++i) {
+        if (!loaded[i].loadScenario(manifest.scenarios[i])) {
+            std::cerr << "Failed to load scenario from file: " << manifest.scenarios[i] << std::endl;
+            return 1;
+        }
+    }
+
+    std::ofstream outputFile;
+    if (!manifest.output.empty()) {
+        outputFile.open(manifest.output);
+        if (!outputFile.is_open()) {
+            std::cerr << "Error: Could not open output file " << manifest.output << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = manifest.output.empty() ? std::cout : outputFile;
+    if (manifest.format == "csv") {
+        out << csvHeader(manifest) << std::flush;
+    }
+
+    std::vector<BatchJob> jobs = manifest.jobs();
+
+    // Each scenario is prepared once per value of points_near_obstacles among its jobs, then shared, read-only, by those jobs
+    auto preparedKey = [&](const BatchJob& job) {
+        return std::make_pair(job.scenario, static_cast<int>(std::stod(manifest.value(job, "points_near_obstacles", "0"))));
+    };
+    std::map<std::pair<int, int>, std::unique_ptr<const PreparedProblem>> problems;
+    for (const BatchJob& job : jobs) {
+        auto key = preparedKey(job);
+        if (!problems.count(key)) {
+            problems[key] = std::make_unique<const PreparedProblem>(loaded[key.first], key.second);
+        }
+    }
+    loaded.clear();
+    int num_threads = manifest.num_threads > 0 ? manifest.num_threads : std::max(1u, std::thread::hardware_concurrency());
+    std::cerr << "Running " << jobs.size() << " jobs on " << num_threads << " threads" << std::endl;
+
+    // Jobs are handed out one at a time, so long runs do not hold up the short ones behind them.
+    // Rows are written as soon as their job ends, in completion order, and flushed so that a partial sweep is never lost.
+    std::mutex output_mutex;
+    int num_done = 0;
+    auto start_time = std::chrono::steady_clock::now();
+    ThreadPool pool(num_threads);
+    pool.parallelFor(jobs.size(), 1, [&](int begin, int end, int) {
+        for (int i = begin; i < end; ++i) {
+            const BatchJob& job = jobs[i];
+            std::string row = formatRow(manifest, job, runJob(*problems.at(preparedKey(job)), manifest, job));
+            std::lock_guard<std::mutex> lock(output_mutex);
+            out << row << std::flush;
+            num_done++;
+        }
+    });
+
+    double wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    std::cerr << num_done << " jobs done in " << wall_time << " seconds" << std::endl;
+    return 0;
+}
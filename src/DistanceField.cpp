@@ -0,0 +1,129 @@
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "DistanceField.hpp"
+#include "Problem.hpp"
+
+// CONSTANTS
+const int MAX_NODES_PER_AXIS = 1024;
+const double FAR = 1e300; // Squared distance of a node with no feature
+
+/*
+One-dimensional squared distance transform: d[q] = min over p of f[p] + ((q - p) * h)^2, computed as the lower
+envelope of the parabolas rooted at each p (Felzenszwalb and Huttenlocher, "Distance Transforms of Sampled Functions").
+f, d, v and z are buffers of n, n, n and n + 1 elements, with stride on f and d.
+*/
+static void transform1D(const double* f, double* d, int n, int stride, double h, std::vector<int>& v, std::vector<double>& z) {
+    auto intersection = [&](int q, int p) { // Abscissa, in nodes, where the parabolas rooted at p < q meet
+        return ((f[q * stride] + (q * h) * (q * h)) - (f[p * stride] + (p * h) * (p * h))) / (2 * h * h * (q - p));
+    };
+    int k = -1; // Index of the rightmost parabola of the envelope
+    for (int q = 0; q < n; ++q) {
+        if (f[q * stride] >= FAR) {
+            continue; // No feature at q
+        }
+        double s = 0.0;
+        while (k >= 0 && (s = intersection(q, v[k])) <= z[k]) {
+            --k;
+        }
+        ++k;
+        v[k] = q;
+        z[k] = k == 0 ? -std::numeric_limits<double>::infinity() : s;
+        z[k + 1] = std::numeric_limits<double>::infinity();
+    }
+    if (k < 0) {
+        for (int q = 0; q < n; ++q) {
+            d[q * stride] = FAR;
+        }
+        return;
+    }
+    k = 0;
+    for (int q = 0; q < n; ++q) {
+        while (z[k + 1] < q) {
+            ++k;
+        }
+        double dq = (q - v[k]) * h;
+        d[q * stride] = dq * dq + f[v[k] * stride];
+    }
+}
+
+// Squared distance from every node to the nearest node where feature is true, columns then rows
+static std::vector<double> squaredDistance(const std::vector<char>& feature, int nx, int ny, double hx, double hy) {
+    std::vector<double> f(feature.size()), d(feature.size());
+    for (size_t c = 0; c < feature.size(); ++c) {
+        f[c] = feature[c] ? 0.0 : FAR;
+    }
+    std::vector<int> v(std::max(nx, ny));
+    std::vector<double> z(std::max(nx, ny) + 1);
+    for (int i = 0; i < nx; ++i) {
+        transform1D(f.data() + i, d.data() + i, ny, nx, hy, v, z);
+    }
+    for (int j = 0; j < ny; ++j) {
+        transform1D(d.data() + j * nx, f.data() + j * nx, nx, 1, hx, v, z);
+    }
+    return f;
+}
+
+void DistanceField::build(const Problem& problem, double spacing) {
+    if (spacing <= 0.0) {
+        spacing = std::max(problem.x_max, problem.y_max) / (MAX_NODES_PER_AXIS - 1);
+    }
+    nx = std::clamp(static_cast<int>(std::ceil(problem.x_max / spacing)), 1, 16 * MAX_NODES_PER_AXIS) + 1;
+    ny = std::clamp(static_cast<int>(std::ceil(problem.y_max / spacing)), 1, 16 * MAX_NODES_PER_AXIS) + 1;
+    cell_w = problem.x_max / (nx - 1);
+    cell_h = problem.y_max / (ny - 1);
+
+    std::vector<char> occupied(static_cast<size_t>(nx) * ny), free(occupied.size());
+    for (int j = 0; j < ny; ++j) {
+        for (int i = 0; i < nx; ++i) {
+            size_t c = static_cast<size_t>(j) * nx + i;
+            occupied[c] = problem.isOccupied(Point(i * cell_w, j * cell_h));
+            free[c] = !occupied[c];
+        }
+    }
+
+    // A node outside the obstacles is about half a spacing further from the nearest occupied node than from the
+    // obstacle boundary, and conversely inside, so both distances are shifted by half a spacing
+    std::vector<double> outside = squaredDistance(occupied, nx, ny, cell_w, cell_h);
+    std::vector<double> inside = squaredDistance(free, nx, ny, cell_w, cell_h);
+    const double half = 0.5 * std::min(cell_w, cell_h);
+    const double none = std::hypot(problem.x_max, problem.y_max); // No obstacle at all
+    values.resize(occupied.size());
+    for (size_t c = 0; c < values.size(); ++c) {
+        if (occupied[c]) {
+            values[c] = inside[c] >= FAR ? -none : -(std::sqrt(inside[c]) - half);
+        } else {
+            values[c] = outside[c] >= FAR ? none : std::sqrt(outside[c]) - half;
+        }
+    }
+}
+
+double DistanceField::interpolate(const Point& p, Point* gradient) const {
+    // Outside the map, the value at the nearest border point minus the distance to it, so that the gradient points back in
+    Point q(std::clamp(p.x, 0.0, (nx - 1) * cell_w), std::clamp(p.y, 0.0, (ny - 1) * cell_h));
+    double outside = std::hypot(p.x - q.x, p.y - q.y);
+
+    double u = q.x / cell_w, v = q.y / cell_h;
+    int i = std::min(static_cast<int>(u), nx - 2);
+    int j = std::min(static_cast<int>(v), ny - 2);
+    double fu = u - i, fv = v - j;
+    const double* row0 = values.data() + static_cast<size_t>(j) * nx + i;
+    const double* row1 = row0 + nx;
+    double bottom = row0[0] + fu * (row0[1] - row0[0]);
+    double top = row1[0] + fu * (row1[1] - row1[0]);
+    if (gradient) {
+        gradient->x = p.x != q.x ? -(p.x - q.x) / outside : ((row0[1] - row0[0]) * (1 - fv) + (row1[1] - row1[0]) * fv) / cell_w;
+        gradient->y = p.y != q.y ? -(p.y - q.y) / outside : (top - bottom) / cell_h;
+    }
+    return bottom + fv * (top - bottom) - outside;
+}
+
+double DistanceField::distance(const Point& p) const {
+    return interpolate(p, nullptr);
+}
+
+double DistanceField::distance(const Point& p, Point& gradient) const {
+    return interpolate(p, &gradient);
+}
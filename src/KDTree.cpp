@@ -0,0 +1,153 @@
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+#include "KDTree.hpp"
+#include "utils.hpp"
+
+KDTree::Node& KDTree::Node::operator=(const Node& other) {
+    p = other.p;
+    id = other.id;
+    left.store(other.left.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    right.store(other.right.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    axis = other.axis;
+    return *this;
+}
+
+void KDTree::insert(const Point& p, int id) {
+    Node node(p, id);
+    if (nodes.empty()) {
+        nodes.push_back(node);
+        return;
+    }
+
+    // Descend to the leaf where p belongs, alternating the splitting axis with the depth
+    int current = 0;
+    while (true) {
+        Node& n = nodes[current];
+        bool go_left = (n.axis == 0) ? (p.x < n.p.x) : (p.y < n.p.y);
+        std::atomic<int>& child = go_left ? n.left : n.right;
+        int next = child.load(std::memory_order_relaxed);
+        if (next == -1) {
+            node.axis = 1 - n.axis;
+            child.store(nodes.size(), std::memory_order_relaxed);
+            nodes.push_back(node); // n may be invalidated from here on
+            return;
+        }
+        current = next;
+    }
+}
+
+void KDTree::reserveConcurrent(std::size_t capacity) {
+    nodes.resize(std::max(capacity, nodes.size()));
+}
+
+void KDTree::insertConcurrent(const Point& p, int id) {
+    Node& node = nodes[id];
+    node.p = p;
+    node.id = id;
+    node.left.store(-1, std::memory_order_relaxed);
+    node.right.store(-1, std::memory_order_relaxed);
+    if (id == 0) {
+        return; // The root is reached without a link
+    }
+
+    int current = 0;
+    while (true) {
+        Node& n = nodes[current];
+        bool go_left = (n.axis == 0) ? (p.x < n.p.x) : (p.y < n.p.y);
+        std::atomic<int>& child = go_left ? n.left : n.right;
+        int next = child.load(std::memory_order_acquire);
+        if (next == -1) {
+            node.axis = 1 - n.axis;
+            // Release, so that a thread reading the link sees the node written above
+            if (child.compare_exchange_strong(next, id, std::memory_order_release, std::memory_order_acquire)) {
+                return;
+            }
+            // Another thread linked a node here first, continue below it
+        }
+        current = next;
+    }
+}
+
+void KDTree::finishConcurrent(std::size_t size) {
+    nodes.resize(size);
+}
+
+int KDTree::nearest(const Point& q) const {
+    if (nodes.empty()) {
+        return -1;
+    }
+
+    int best_id = -1;
+    double best_dist2 = std::numeric_limits<double>::infinity();
+
+    // Iterative depth-first search with an explicit stack, so that a degenerate (unbalanced) tree cannot overflow the call stack.
+    // Each entry stores a node and a lower bound on the squared distance from q to any point of its subtree.
+    thread_local std::vector<std::pair<int, double>> stack; // Reused across queries to avoid an allocation per call
+    stack.clear();
+    stack.emplace_back(0, 0.0);
+    while (!stack.empty()) {
+        auto [index, bound] = stack.back();
+        stack.pop_back();
+        if (bound > best_dist2) {
+            continue; // The whole subtree is farther than the current best
+        }
+
+        const Node& n = nodes[index];
+        double dx = n.p.x - q.x;
+        double dy = n.p.y - q.y;
+        double dist2 = dx * dx + dy * dy;
+        if (dist2 < best_dist2 || (dist2 == best_dist2 && n.id < best_id)) { // Ties go to the smallest id, like a linear scan would
+            best_dist2 = dist2;
+            best_id = n.id;
+        }
+
+        double diff = (n.axis == 0) ? (q.x - n.p.x) : (q.y - n.p.y);
+        int left = n.left.load(std::memory_order_acquire), right = n.right.load(std::memory_order_acquire);
+        int near_child = diff < 0 ? left : right;
+        int far_child = diff < 0 ? right : left;
+        // Push the far side first so that the near side is explored first
+        if (far_child != -1) {
+            stack.emplace_back(far_child, diff * diff);
+        }
+        if (near_child != -1) {
+            stack.emplace_back(near_child, bound);
+        }
+    }
+    return best_id;
+}
+
+void KDTree::radius(const Point& q, double r, std::vector<int>& out) const {
+    out.clear();
+    if (nodes.empty()) {
+        return;
+    }
+
+    thread_local std::vector<int> stack;
+    stack.clear();
+    stack.push_back(0);
+    while (!stack.empty()) {
+        const Node& n = nodes[stack.back()];
+        stack.pop_back();
+
+        if (euclideanDistance(n.p, q) < r) {
+            out.push_back(n.id);
+        }
+
+        double diff = (n.axis == 0) ? (q.x - n.p.x) : (q.y - n.p.y);
+        int left = n.left.load(std::memory_order_acquire), right = n.right.load(std::memory_order_acquire);
+        // The left subtree holds coordinates < split, the right one coordinates >= split
+        if (left != -1 && diff < r) {
+            stack.push_back(left);
+        }
+        if (right != -1 && diff > -r) {
+            stack.push_back(right);
+        }
+    }
+    std::sort(out.begin(), out.end()); // Keep the same visiting order as a scan over the vertices
+}
+
+void KDTree::clear() {
+    nodes.clear();
+}
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <numeric>
+
+#include "MultiSwarm.hpp"
+
+// CONSTANTS
+const double INF = 1e9;
+
+MultiSwarm::MultiSwarm(const Problem& problem, int num_islands, int num_particles, int num_waypoints, uint64_t seed)
+    : global_best_cost(INF) {
+    // Each island derives its own seed, so its particle streams differ from those of the other islands
+    RandomStream seeds(seed, streamId(StreamDomain::PSO_ISLAND, 0));
+    islands.reserve(num_islands);
+    for (int k = 0; k < num_islands; ++k) {
+        islands.emplace_back(problem, num_particles, num_waypoints, 1, seeds.nextU64());
+    }
+}
+
+std::vector<int> MultiSwarm::sources(int island) const {
+    int num_islands = islands.size();
+    if (topology == MigrationTopology::RING) {
+        return {(island + num_islands - 1) % num_islands};
+    }
+    std::vector<int> others;
+    for (int k = 0; k < num_islands; ++k) {
+        if (k != island) {
+            others.push_back(k);
+        }
+    }
+    return others;
+}
+
+std::vector<int> MultiSwarm::readers(int island) const {
+    int num_islands = islands.size();
+    if (topology == MigrationTopology::RING) {
+        return {(island + 1) % num_islands};
+    }
+    return sources(island); // The fully connected topology is symmetric
+}
+
+// Spins until counter reaches epoch, adding the time spent to wait_time
+static void waitForEpoch(const std::atomic<int>& counter, int epoch, double& wait_time) {
+    if (counter.load(std::memory_order_acquire) >= epoch) {
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    while (counter.load(std::memory_order_acquire) < epoch) {
+        std::this_thread::yield();
+    }
+    wait_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void MultiSwarm::migrate(int island, int epoch, int num_migrants) {
+    PSO& pso = islands[island];
+    Swarm& swarm = pso.swarm;
+    Mailbox& mailbox = mailboxes[island];
+    IslandStats& island_stats = stats[island];
+    int slot = epoch % 2;
+    num_migrants = std::min(num_migrants, swarm.num_particles);
+
+    // Particles sorted from best to worst personal best, ties broken by index so that the order is deterministic
+    std::vector<int> order(swarm.num_particles);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return swarm.best_cost[a] < swarm.best_cost[b]; });
+
+    // The slot still holds the migrants of epoch - 2 until every reader has read them
+    for (int reader : readers(island)) {
+        waitForEpoch(mailboxes[reader].consumed, epoch - 2, island_stats.wait_time);
+    }
+    std::vector<Migrant>& outbox = mailbox.slots[slot];
+    outbox.resize(num_migrants);
+    for (int m = 0; m < num_migrants; ++m) {
+        swarm.copyBest(order[m], outbox[m].waypoints);
+        outbox[m].cost = swarm.best_cost[order[m]];
+    }
+    mailbox.published.store(epoch, std::memory_order_release);
+
+    // Gather the migrants of the sources, in source order, and keep the best num_migrants of them
+    std::vector<Migrant> incoming;
+    for (int source : sources(island)) {
+        waitForEpoch(mailboxes[source].published, epoch, island_stats.wait_time);
+        const std::vector<Migrant>& migrants = mailboxes[source].slots[slot];
+        incoming.insert(incoming.end(), migrants.begin(), migrants.end());
+    }
+    mailbox.consumed.store(epoch, std::memory_order_release);
+    std::stable_sort(incoming.begin(), incoming.end(), [](const Migrant& a, const Migrant& b) { return a.cost < b.cost; });
+    incoming.resize(std::min<size_t>(incoming.size(), num_migrants));
+
+    // The best immigrant replaces the worst particle, the second best the second worst, and so on, as long as it is better
+    for (size_t m = 0; m < incoming.size(); ++m) {
+        int k = order[swarm.num_particles - 1 - m];
+        const Migrant& migrant = incoming[m];
+        if (migrant.cost >= swarm.best_cost[k]) {
+            break;
+        }
+        for (int j = 0; j < swarm.num_waypoints; ++j) {
+            swarm.x(k)[j] = migrant.waypoints[j].x;
+            swarm.y(k)[j] = migrant.waypoints[j].y;
+            swarm.vx(k)[j] = 0.0;
+            swarm.vy(k)[j] = 0.0;
+        }
+        swarm.saveBest(k);
+        swarm.best_cost[k] = migrant.cost;
+        swarm.stagnation_counter[k] = 0;
+        if (migrant.cost < pso.global_best_cost) {
+            pso.global_best_cost = migrant.cost;
+            pso.global_best_waypoints = migrant.waypoints;
+        }
+        island_stats.migrants_accepted++;
+    }
+}
+
+void MultiSwarm::collectResults() {
+    // The lowest index wins ties, so the result does not depend on which island finished first
+    global_best_cost = INF;
+    global_best_waypoints.clear();
+    best_island = 0;
+    for (size_t k = 0; k < islands.size(); ++k) {
+        if (k == 0 || stats[k].best_cost < global_best_cost) {
+            global_best_cost = stats[k].best_cost;
+            global_best_waypoints = stats[k].best_waypoints;
+            best_island = k;
+        }
+    }
+}
@@ -0,0 +1,395 @@
+#include <vector>
+#include <string>
+#include <cmath>
+#include <algorithm>
+
+#include "ObstacleBounds.hpp"
+#include "Problem.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define OBSTACLE_KERNELS_X86
+#endif
+
+// CONSTANTS
+const double EMPTY_BOUND = -1e30; // Padding rectangles are reduced to a point far outside any environment
+const double EPS = 1e-12; // Same tolerance as segmentCollisionDistance
+
+void ObstacleBounds::assign(const std::vector<Obstacle>& obstacles) {
+    clear();
+    for (const auto& obs : obstacles) {
+        push_back(obs);
+    }
+    pad();
+}
+
+void ObstacleBounds::attach(std::shared_ptr<const void> _owner, const double* xmin, const double* xmax, const double* ymin, const double* ymax, std::size_t n) {
+    clear();
+    owner = std::move(_owner);
+    attached[0] = xmin;
+    attached[1] = xmax;
+    attached[2] = ymin;
+    attached[3] = ymax;
+    count = n;
+}
+
+void ObstacleBounds::push_back(const Obstacle& obs) {
+    // The upper bounds are computed the same way as the corners in segmentIntersectsObstacle, so that the kernels see the same values
+    detach();
+    storage[0].push_back(obs.ll_corner.x);
+    storage[1].push_back(obs.ll_corner.x + obs.lx);
+    storage[2].push_back(obs.ll_corner.y);
+    storage[3].push_back(obs.ll_corner.y + obs.ly);
+    ++count;
+}
+
+void ObstacleBounds::push_empty() {
+    detach();
+    for (auto& bound : storage) {
+        bound.push_back(EMPTY_BOUND);
+    }
+    ++count;
+}
+
+void ObstacleBounds::pad() {
+    while (count % LANES != 0) {
+        push_empty();
+    }
+}
+
+void ObstacleBounds::clear() {
+    for (auto& bound : storage) {
+        bound.clear();
+    }
+    owner.reset();
+    count = 0;
+}
+
+void ObstacleBounds::detach() {
+    if (!owner) {
+        return;
+    }
+    for (int k = 0; k < 4; ++k) {
+        storage[k].assign(attached[k], attached[k] + count);
+    }
+    owner.reset();
+}
+
+/*
+Segment-vs-rectangle hit test.
+segmentIntersectsObstacle tests the segment against the four edges with segmentsIntersect, which computes
+t = numerator / det for both segments and checks that t lies in [0, 1]. With axis-aligned edges most terms of
+the determinant vanish, and the division is replaced by comparing the numerator with det (after flipping both
+so that det > 0). The only possible difference with the reference is a parameter rounding to exactly 1 after
+the division, i.e. a segment grazing a corner within one rounding error.
+*/
+
+static inline bool edgeCrossed(double det, double n1, double n2) {
+    if (det == 0) {
+        return false; // Parallel, as in segmentsIntersect
+    }
+    if (det < 0) {
+        det = -det;
+        n1 = -n1;
+        n2 = -n2;
+    }
+    return n1 >= 0 && n1 <= det && n2 >= 0 && n2 <= det;
+}
+
+static bool hitScalar(const double* x0, const double* x1, const double* y0, const double* y1, std::size_t n,
+                      double p1x, double p1y, double d1x, double d1y) {
+    for (std::size_t i = 0; i < n; ++i) {
+        double w = x1[i] - x0[i];
+        double h = y1[i] - y0[i];
+        double ax0 = x0[i] - p1x, ax1 = x1[i] - p1x;
+        double ay0 = y0[i] - p1y, ay1 = y1[i] - p1y;
+        if (edgeCrossed(-(d1y * w), -(ay0 * w), ax0 * d1y - ay0 * d1x) // Bottom edge, from (xmin, ymin) along (w, 0)
+            || edgeCrossed(d1x * h, ax1 * h, ax1 * d1y - ay0 * d1x) // Right edge, from (xmax, ymin) along (0, h)
+            || edgeCrossed(d1y * w, ay1 * w, ax1 * d1y - ay1 * d1x) // Top edge, from (xmax, ymax) along (-w, 0)
+            || edgeCrossed(-(d1x * h), -(ax0 * h), ax0 * d1y - ay1 * d1x)) { // Left edge, from (xmin, ymax) along (0, -h)
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+Penetration length (Liang-Barsky).
+The clipping parameters p are the same for all the rectangles, so the branch on |p| of the reference is taken
+once per segment, and the per-rectangle part reduces to max/min updates. Rejecting early as the reference does
+gives the same result as rejecting at the end when t1 < t0, since t0 only grows and t1 only shrinks.
+*/
+
+struct Clip{
+    double p; // -dx, dx, -dy or dy
+    bool parallel; // |p| <= EPS
+};
+
+static double penetrationScalar(const double* x0, const double* x1, const double* y0, const double* y1, std::size_t n,
+                                double p1x, double p1y, const Clip clips[4], double seg_len, double t_start, double t_end) {
+    double total = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        double q[4] = {p1x - x0[i], x1[i] - p1x, p1y - y0[i], y1[i] - p1y};
+        double t0 = t_start;
+        double t1 = t_end;
+        bool rejected = false;
+        for (int k = 0; k < 4; ++k) {
+            if (clips[k].parallel) {
+                rejected = rejected || q[k] < -EPS;
+                continue;
+            }
+            double r = q[k] / clips[k].p;
+            if (clips[k].p < 0.0) {
+                t0 = r > t0 ? r : t0;
+            } else {
+                t1 = r < t1 ? r : t1;
+            }
+        }
+        double t_in = std::max(0.0, t0);
+        double t_out = std::min(1.0, t1);
+        if (!rejected && !(t1 < t0) && !(t_out < t_in)) {
+            total += (t_out - t_in) * seg_len;
+        }
+    }
+    return total;
+}
+
+#ifdef OBSTACLE_KERNELS_X86
+
+// SSE2 kernels, 2 rectangles per instruction (SSE2 is part of the x86-64 baseline)
+
+static inline __m128d edgeCrossedSSE2(__m128d det, __m128d n1, __m128d n2) {
+    const __m128d sign_mask = _mm_set1_pd(-0.0);
+    const __m128d zero = _mm_setzero_pd();
+    __m128d sign = _mm_and_pd(det, sign_mask);
+    __m128d abs_det = _mm_andnot_pd(sign_mask, det);
+    n1 = _mm_xor_pd(n1, sign);
+    n2 = _mm_xor_pd(n2, sign);
+    __m128d m = _mm_cmpneq_pd(det, zero);
+    m = _mm_and_pd(m, _mm_cmpge_pd(n1, zero));
+    m = _mm_and_pd(m, _mm_cmple_pd(n1, abs_det));
+    m = _mm_and_pd(m, _mm_cmpge_pd(n2, zero));
+    m = _mm_and_pd(m, _mm_cmple_pd(n2, abs_det));
+    return m;
+}
+
+static bool hitSSE2(const double* x0, const double* x1, const double* y0, const double* y1, std::size_t n,
+                    double p1x, double p1y, double d1x, double d1y) {
+    const __m128d sign_mask = _mm_set1_pd(-0.0);
+    const __m128d P1X = _mm_set1_pd(p1x), P1Y = _mm_set1_pd(p1y);
+    const __m128d D1X = _mm_set1_pd(d1x), D1Y = _mm_set1_pd(d1y);
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d X0 = _mm_loadu_pd(x0 + i), X1 = _mm_loadu_pd(x1 + i);
+        __m128d Y0 = _mm_loadu_pd(y0 + i), Y1 = _mm_loadu_pd(y1 + i);
+        __m128d W = _mm_sub_pd(X1, X0), H = _mm_sub_pd(Y1, Y0);
+        __m128d AX0 = _mm_sub_pd(X0, P1X), AX1 = _mm_sub_pd(X1, P1X);
+        __m128d AY0 = _mm_sub_pd(Y0, P1Y), AY1 = _mm_sub_pd(Y1, P1Y);
+
+        __m128d hit = edgeCrossedSSE2(_mm_xor_pd(_mm_mul_pd(D1Y, W), sign_mask), _mm_xor_pd(_mm_mul_pd(AY0, W), sign_mask),
+                                      _mm_sub_pd(_mm_mul_pd(AX0, D1Y), _mm_mul_pd(AY0, D1X)));
+        hit = _mm_or_pd(hit, edgeCrossedSSE2(_mm_mul_pd(D1X, H), _mm_mul_pd(AX1, H),
+                                             _mm_sub_pd(_mm_mul_pd(AX1, D1Y), _mm_mul_pd(AY0, D1X))));
+        hit = _mm_or_pd(hit, edgeCrossedSSE2(_mm_mul_pd(D1Y, W), _mm_mul_pd(AY1, W),
+                                             _mm_sub_pd(_mm_mul_pd(AX1, D1Y), _mm_mul_pd(AY1, D1X))));
+        hit = _mm_or_pd(hit, edgeCrossedSSE2(_mm_xor_pd(_mm_mul_pd(D1X, H), sign_mask), _mm_xor_pd(_mm_mul_pd(AX0, H), sign_mask),
+                                             _mm_sub_pd(_mm_mul_pd(AX0, D1Y), _mm_mul_pd(AY1, D1X))));
+        if (_mm_movemask_pd(hit)) {
+            return true;
+        }
+    }
+    return hitScalar(x0 + i, x1 + i, y0 + i, y1 + i, n - i, p1x, p1y, d1x, d1y);
+}
+
+static double penetrationSSE2(const double* x0, const double* x1, const double* y0, const double* y1, std::size_t n,
+                              double p1x, double p1y, const Clip clips[4], double seg_len, double t_start, double t_end) {
+    const __m128d P1X = _mm_set1_pd(p1x), P1Y = _mm_set1_pd(p1y);
+    const __m128d zero = _mm_setzero_pd(), one = _mm_set1_pd(1.0), minus_eps = _mm_set1_pd(-EPS);
+    __m128d total = zero;
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d Q[4] = {_mm_sub_pd(P1X, _mm_loadu_pd(x0 + i)), _mm_sub_pd(_mm_loadu_pd(x1 + i), P1X),
+                        _mm_sub_pd(P1Y, _mm_loadu_pd(y0 + i)), _mm_sub_pd(_mm_loadu_pd(y1 + i), P1Y)};
+        __m128d T0 = _mm_set1_pd(t_start), T1 = _mm_set1_pd(t_end);
+        __m128d rejected = zero;
+        for (int k = 0; k < 4; ++k) {
+            if (clips[k].parallel) {
+                rejected = _mm_or_pd(rejected, _mm_cmplt_pd(Q[k], minus_eps));
+                continue;
+            }
+            __m128d R = _mm_div_pd(Q[k], _mm_set1_pd(clips[k].p));
+            if (clips[k].p < 0.0) {
+                T0 = _mm_max_pd(R, T0); // R > T0 ? R : T0
+            } else {
+                T1 = _mm_min_pd(R, T1); // R < T1 ? R : T1
+            }
+        }
+        __m128d T_IN = _mm_max_pd(T0, zero);
+        __m128d T_OUT = _mm_min_pd(T1, one);
+        rejected = _mm_or_pd(rejected, _mm_cmplt_pd(T1, T0));
+        rejected = _mm_or_pd(rejected, _mm_cmplt_pd(T_OUT, T_IN));
+        __m128d length = _mm_mul_pd(_mm_sub_pd(T_OUT, T_IN), _mm_set1_pd(seg_len));
+        total = _mm_add_pd(total, _mm_andnot_pd(rejected, length));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, total);
+    return lanes[0] + lanes[1] + penetrationScalar(x0 + i, x1 + i, y0 + i, y1 + i, n - i, p1x, p1y, clips, seg_len, t_start, t_end);
+}
+
+// AVX2 kernels, 4 rectangles per instruction, only called when the CPU supports AVX2
+
+__attribute__((target("avx2"))) static inline __m256d edgeCrossedAVX2(__m256d det, __m256d n1, __m256d n2) {
+    const __m256d sign_mask = _mm256_set1_pd(-0.0);
+    const __m256d zero = _mm256_setzero_pd();
+    __m256d sign = _mm256_and_pd(det, sign_mask);
+    __m256d abs_det = _mm256_andnot_pd(sign_mask, det);
+    n1 = _mm256_xor_pd(n1, sign);
+    n2 = _mm256_xor_pd(n2, sign);
+    __m256d m = _mm256_cmp_pd(det, zero, _CMP_NEQ_UQ);
+    m = _mm256_and_pd(m, _mm256_cmp_pd(n1, zero, _CMP_GE_OQ));
+    m = _mm256_and_pd(m, _mm256_cmp_pd(n1, abs_det, _CMP_LE_OQ));
+    m = _mm256_and_pd(m, _mm256_cmp_pd(n2, zero, _CMP_GE_OQ));
+    m = _mm256_and_pd(m, _mm256_cmp_pd(n2, abs_det, _CMP_LE_OQ));
+    return m;
+}
+
+__attribute__((target("avx2"))) static bool hitAVX2(const double* x0, const double* x1, const double* y0, const double* y1, std::size_t n,
+                                                    double p1x, double p1y, double d1x, double d1y) {
+    const __m256d sign_mask = _mm256_set1_pd(-0.0);
+    const __m256d P1X = _mm256_set1_pd(p1x), P1Y = _mm256_set1_pd(p1y);
+    const __m256d D1X = _mm256_set1_pd(d1x), D1Y = _mm256_set1_pd(d1y);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d X0 = _mm256_loadu_pd(x0 + i), X1 = _mm256_loadu_pd(x1 + i);
+        __m256d Y0 = _mm256_loadu_pd(y0 + i), Y1 = _mm256_loadu_pd(y1 + i);
+        __m256d W = _mm256_sub_pd(X1, X0), H = _mm256_sub_pd(Y1, Y0);
+        __m256d AX0 = _mm256_sub_pd(X0, P1X), AX1 = _mm256_sub_pd(X1, P1X);
+        __m256d AY0 = _mm256_sub_pd(Y0, P1Y), AY1 = _mm256_sub_pd(Y1, P1Y);
+
+        __m256d hit = edgeCrossedAVX2(_mm256_xor_pd(_mm256_mul_pd(D1Y, W), sign_mask), _mm256_xor_pd(_mm256_mul_pd(AY0, W), sign_mask),
+                                      _mm256_sub_pd(_mm256_mul_pd(AX0, D1Y), _mm256_mul_pd(AY0, D1X)));
+        hit = _mm256_or_pd(hit, edgeCrossedAVX2(_mm256_mul_pd(D1X, H), _mm256_mul_pd(AX1, H),
+                                                _mm256_sub_pd(_mm256_mul_pd(AX1, D1Y), _mm256_mul_pd(AY0, D1X))));
+        hit = _mm256_or_pd(hit, edgeCrossedAVX2(_mm256_mul_pd(D1Y, W), _mm256_mul_pd(AY1, W),
+                                                _mm256_sub_pd(_mm256_mul_pd(AX1, D1Y), _mm256_mul_pd(AY1, D1X))));
+        hit = _mm256_or_pd(hit, edgeCrossedAVX2(_mm256_xor_pd(_mm256_mul_pd(D1X, H), sign_mask), _mm256_xor_pd(_mm256_mul_pd(AX0, H), sign_mask),
+                                                _mm256_sub_pd(_mm256_mul_pd(AX0, D1Y), _mm256_mul_pd(AY1, D1X))));
+        if (_mm256_movemask_pd(hit)) {
+            _mm256_zeroupper();
+            return true;
+        }
+    }
+    _mm256_zeroupper(); // Leave the upper halves clean for the SSE code that follows, or every SSE instruction pays a transition penalty
+    return hitScalar(x0 + i, x1 + i, y0 + i, y1 + i, n - i, p1x, p1y, d1x, d1y);
+}
+
+__attribute__((target("avx2"))) static double penetrationAVX2(const double* x0, const double* x1, const double* y0, const double* y1, std::size_t n,
+                                                              double p1x, double p1y, const Clip clips[4], double seg_len, double t_start, double t_end) {
+    const __m256d P1X = _mm256_set1_pd(p1x), P1Y = _mm256_set1_pd(p1y);
+    const __m256d zero = _mm256_setzero_pd(), one = _mm256_set1_pd(1.0), minus_eps = _mm256_set1_pd(-EPS);
+    __m256d total = zero;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d Q[4] = {_mm256_sub_pd(P1X, _mm256_loadu_pd(x0 + i)), _mm256_sub_pd(_mm256_loadu_pd(x1 + i), P1X),
+                        _mm256_sub_pd(P1Y, _mm256_loadu_pd(y0 + i)), _mm256_sub_pd(_mm256_loadu_pd(y1 + i), P1Y)};
+        __m256d T0 = _mm256_set1_pd(t_start), T1 = _mm256_set1_pd(t_end);
+        __m256d rejected = zero;
+        for (int k = 0; k < 4; ++k) {
+            if (clips[k].parallel) {
+                rejected = _mm256_or_pd(rejected, _mm256_cmp_pd(Q[k], minus_eps, _CMP_LT_OQ));
+                continue;
+            }
+            __m256d R = _mm256_div_pd(Q[k], _mm256_set1_pd(clips[k].p));
+            if (clips[k].p < 0.0) {
+                T0 = _mm256_max_pd(R, T0);
+            } else {
+                T1 = _mm256_min_pd(R, T1);
+            }
+        }
+        __m256d T_IN = _mm256_max_pd(T0, zero);
+        __m256d T_OUT = _mm256_min_pd(T1, one);
+        rejected = _mm256_or_pd(rejected, _mm256_cmp_pd(T1, T0, _CMP_LT_OQ));
+        rejected = _mm256_or_pd(rejected, _mm256_cmp_pd(T_OUT, T_IN, _CMP_LT_OQ));
+        __m256d length = _mm256_mul_pd(_mm256_sub_pd(T_OUT, T_IN), _mm256_set1_pd(seg_len));
+        total = _mm256_add_pd(total, _mm256_andnot_pd(rejected, length));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, total);
+    _mm256_zeroupper();
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3])
+        + penetrationScalar(x0 + i, x1 + i, y0 + i, y1 + i, n - i, p1x, p1y, clips, seg_len, t_start, t_end);
+}
+
+#endif // OBSTACLE_KERNELS_X86
+
+// Runtime dispatch
+
+typedef bool (*HitKernel)(const double*, const double*, const double*, const double*, std::size_t, double, double, double, double);
+typedef double (*PenetrationKernel)(const double*, const double*, const double*, const double*, std::size_t, double, double, const Clip*, double, double, double);
+
+struct Kernels{
+    const char* name;
+    HitKernel hit;
+    PenetrationKernel penetration;
+};
+
+static const Kernels SCALAR_KERNELS = {"scalar", hitScalar, penetrationScalar};
+#ifdef OBSTACLE_KERNELS_X86
+static const Kernels SSE2_KERNELS = {"sse2", hitSSE2, penetrationSSE2};
+static const Kernels AVX2_KERNELS = {"avx2", hitAVX2, penetrationAVX2};
+#endif
+
+static bool cpuSupports(const std::string& name) {
+#ifdef OBSTACLE_KERNELS_X86
+    if (name == "avx2") return __builtin_cpu_supports("avx2");
+    if (name == "sse2") return __builtin_cpu_supports("sse2");
+#endif
+    return name == "scalar";
+}
+
+static const Kernels* kernelsByName(const std::string& name) {
+#ifdef OBSTACLE_KERNELS_X86
+    if (name == "avx2") return &AVX2_KERNELS;
+    if (name == "sse2") return &SSE2_KERNELS;
+#endif
+    if (name == "scalar") return &SCALAR_KERNELS;
+    return nullptr;
+}
+
+static const Kernels*& activeKernels() {
+    // Picks the widest kernels supported by the CPU on first use
+    static const Kernels* kernels = cpuSupports("avx2") ? kernelsByName("avx2")
+                                  : cpuSupports("sse2") ? kernelsByName("sse2")
+                                  : &SCALAR_KERNELS;
+    return kernels;
+}
+
+std::string obstacleKernelName() {
+    return activeKernels()->name;
+}
+
+bool selectObstacleKernel(const std::string& name) {
+    const Kernels* kernels = kernelsByName(name);
+    if (!kernels || !cpuSupports(name)) {
+        return false;
+    }
+    activeKernels() = kernels;
+    return true;
+}
+
+bool segmentHitsBounds(const ObstacleBounds& bounds, std::size_t begin, std::size_t end, const Point& p1, const Point& p2) {
+    return activeKernels()->hit(bounds.xmin() + begin, bounds.xmax() + begin, bounds.ymin() + begin, bounds.ymax() + begin,
+                                end - begin, p1.x, p1.y, p2.x - p1.x, p2.y - p1.y);
+}
+
+double segmentPenetrationBounds(const ObstacleBounds& bounds, std::size_t begin, std::size_t end, const Point& p1, const Point& p2, double t_start, double t_end) {
+    const double dx = p2.x - p1.x;
+    const double dy = p2.y - p1.y;
+    const double seg_len = std::sqrt(dx * dx + dy * dy);
+    if (seg_len <= EPS) {
+        return 0.0;
+    }
+    const Clip clips[4] = {{-dx, std::abs(dx) <= EPS}, {dx, std::abs(dx) <= EPS}, {-dy, std::abs(dy) <= EPS}, {dy, std::abs(dy) <= EPS}};
+    return activeKernels()->penetration(bounds.xmin() + begin, bounds.xmax() + begin, bounds.ymin() + begin, bounds.ymax() + begin,
+                                        end - begin, p1.x, p1.y, clips, seg_len, t_start, t_end);
+}
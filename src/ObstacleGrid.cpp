@@ -0,0 +1,184 @@
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include "ObstacleGrid.hpp"
+#include "Problem.hpp"
+#include "utils.hpp"
+
+// CONSTANTS
+const int MAX_CELLS_PER_AXIS = 1024;
+
+void ObstacleGrid::build(const std::vector<Obstacle>& obstacles, double _x_max, double _y_max) {
+    clear();
+    x_max = _x_max;
+    y_max = _y_max;
+
+    // Aim for about one obstacle per cell, keeping cells roughly square
+    double n = std::max<double>(1.0, obstacles.size());
+    nx = std::clamp(static_cast<int>(std::ceil(std::sqrt(n * x_max / y_max))), 1, MAX_CELLS_PER_AXIS);
+    ny = std::clamp(static_cast<int>(std::ceil(std::sqrt(n * y_max / x_max))), 1, MAX_CELLS_PER_AXIS);
+    cell_w = x_max / nx;
+    cell_h = y_max / ny;
+
+    // Obstacles are registered in every cell their (slightly inflated) bounds touch, so that a segment
+    // walked into a neighboring cell because of rounding still meets them
+    const double pad = 1e-9 * std::max(x_max, y_max);
+    auto cellRange = [&](const Obstacle& obs, int& ix0, int& ix1, int& iy0, int& iy1) {
+        ix0 = std::clamp(static_cast<int>(std::floor((obs.ll_corner.x - pad) / cell_w)), 0, nx - 1);
+        ix1 = std::clamp(static_cast<int>(std::floor((obs.ll_corner.x + obs.lx + pad) / cell_w)), 0, nx - 1);
+        iy0 = std::clamp(static_cast<int>(std::floor((obs.ll_corner.y - pad) / cell_h)), 0, ny - 1);
+        iy1 = std::clamp(static_cast<int>(std::floor((obs.ll_corner.y + obs.ly + pad) / cell_h)), 0, ny - 1);
+    };
+
+    // Two passes (count, then fill) to lay the cell lists out contiguously
+    std::vector<int> count(nx * ny, 0);
+    for (const auto& obs : obstacles) {
+        int ix0, ix1, iy0, iy1;
+        cellRange(obs, ix0, ix1, iy0, iy1);
+        for (int iy = iy0; iy <= iy1; ++iy) {
+            for (int ix = ix0; ix <= ix1; ++ix) {
+                count[iy * nx + ix]++;
+            }
+        }
+    }
+    const int lanes = ObstacleBounds::LANES;
+    cell_start.assign(nx * ny + 1, 0);
+    for (int c = 0; c < nx * ny; ++c) {
+        cell_start[c + 1] = cell_start[c] + (count[c] + lanes - 1) / lanes * lanes; // Each cell is padded so the kernels never need a scalar tail
+    }
+
+    std::vector<int> cell_items(cell_start.back(), -1); // Obstacle indices, grouped by cell, -1 for the padding
+    std::vector<int> fill(cell_start.begin(), cell_start.end() - 1);
+    for (size_t i = 0; i < obstacles.size(); ++i) {
+        int ix0, ix1, iy0, iy1;
+        cellRange(obstacles[i], ix0, ix1, iy0, iy1);
+        for (int iy = iy0; iy <= iy1; ++iy) {
+            for (int ix = ix0; ix <= ix1; ++ix) {
+                cell_items[fill[iy * nx + ix]++] = i;
+            }
+        }
+    }
+
+    cell_bounds.clear();
+    for (int item : cell_items) {
+        if (item >= 0) {
+            cell_bounds.push_back(obstacles[item]);
+        } else {
+            cell_bounds.push_empty();
+        }
+    }
+}
+
+void ObstacleGrid::attach(std::shared_ptr<const void> _owner, int _nx, int _ny, double _x_max, double _y_max, const int* _cell_start, const ObstacleBounds& _cell_bounds) {
+    clear();
+    owner = std::move(_owner);
+    nx = _nx;
+    ny = _ny;
+    x_max = _x_max;
+    y_max = _y_max;
+    cell_w = x_max / nx;
+    cell_h = y_max / ny;
+    attached_cell_start = _cell_start;
+    cell_bounds = _cell_bounds;
+}
+
+void ObstacleGrid::clear() {
+    nx = ny = 0;
+    cell_start.clear();
+    owner.reset();
+    attached_cell_start = nullptr;
+    cell_bounds.clear();
+}
+
+template <class Visit>
+void ObstacleGrid::traverse(const Point& p1, const Point& p2, Visit visit) const {
+    const double dx = p2.x - p1.x;
+    const double dy = p2.y - p1.y;
+    const double inf = std::numeric_limits<double>::infinity();
+
+    // Clip the segment to the environment: the parts outside of it cannot meet any obstacle
+    double ta = 0.0;
+    double tb = 1.0;
+    auto clip = [&](double p, double q) -> bool {
+        if (p == 0.0) {
+            return q >= 0.0;
+        }
+        double r = q / p;
+        if (p < 0.0) {
+            if (r > tb) return false;
+            ta = std::max(ta, r);
+        } else {
+            if (r < ta) return false;
+            tb = std::min(tb, r);
+        }
+        return true;
+    };
+    if (!clip(-dx, p1.x) || !clip(dx, x_max - p1.x) || !clip(-dy, p1.y) || !clip(dy, y_max - p1.y)) {
+        return;
+    }
+
+    // Amanatides-Woo traversal: step to the next cell across whichever grid line is crossed first
+    int ix = std::clamp(static_cast<int>(std::floor((p1.x + ta * dx) / cell_w)), 0, nx - 1);
+    int iy = std::clamp(static_cast<int>(std::floor((p1.y + ta * dy) / cell_h)), 0, ny - 1);
+    const int step_x = (dx > 0) - (dx < 0);
+    const int step_y = (dy > 0) - (dy < 0);
+
+    // Parameters at which the segment leaves the current column and row, recomputed from the cell
+    // indices rather than accumulated so that rounding errors do not build up along long segments
+    auto exitX = [&]() { return step_x == 0 ? inf : ((ix + (step_x > 0)) * cell_w - p1.x) / dx; };
+    auto exitY = [&]() { return step_y == 0 ? inf : ((iy + (step_y > 0)) * cell_h - p1.y) / dy; };
+    double t_max_x = exitX();
+    double t_max_y = exitY();
+
+    double t = ta;
+    while (true) {
+        double t_next = std::min({t_max_x, t_max_y, tb});
+        if (!visit(iy * nx + ix, t, std::max(t, t_next))) {
+            return;
+        }
+        if (t_next >= tb) {
+            return;
+        }
+        if (t_max_x < t_max_y) {
+            ix += step_x;
+            if (ix < 0 || ix >= nx) return;
+            t_max_x = exitX();
+        } else {
+            iy += step_y;
+            if (iy < 0 || iy >= ny) return;
+            t_max_y = exitY();
+        }
+        t = std::max(t, t_next);
+    }
+}
+
+bool ObstacleGrid::segmentIntersects(const Point& p1, const Point& p2) const {
+    const int* cell_start = cellStart();
+    bool hit = false;
+    traverse(p1, p2, [&](int cell, double, double) {
+        if (cell_start[cell] != cell_start[cell + 1] && segmentHitsBounds(cell_bounds, cell_start[cell], cell_start[cell + 1], p1, p2)) {
+            hit = true;
+            return false; // Stop the traversal
+        }
+        return true;
+    });
+    return hit;
+}
+
+double ObstacleGrid::segmentCollisionDistance(const Point& p1, const Point& p2) const {
+    // The pieces of the segment inside each cell partition it, so summing the distance travelled into the
+    // obstacles of each cell over its own piece counts every obstacle once, even those spanning several cells
+    const int* cell_start = cellStart();
+    double total_collision_distance = 0.0;
+    traverse(p1, p2, [&](int cell, double t_in, double t_out) {
+        if (cell_start[cell] != cell_start[cell + 1]) {
+            total_collision_distance += segmentPenetrationBounds(cell_bounds, cell_start[cell], cell_start[cell + 1], p1, p2, t_in, t_out);
+        }
+        return true;
+    });
+    return total_collision_distance;
+}
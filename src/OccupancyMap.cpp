@@ -0,0 +1,121 @@
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "OccupancyMap.hpp"
+#include "Problem.hpp"
+#include "utils.hpp"
+
+// CONSTANTS
+const double CELLS_PER_OBSTACLE = 64.0; // Enough cells for most of them to lie entirely inside or outside the obstacles
+const double MIN_CELLS = 65536.0;
+const double MAX_CELLS = 16777216.0; // 2^24 cells take about 5 MB
+
+void OccupancyMap::build(const std::vector<Obstacle>& obstacles, double _x_max, double _y_max, double cell_size) {
+    clear();
+    x_max = _x_max;
+    y_max = _y_max;
+
+    if (cell_size <= 0.0) {
+        double cells = std::clamp(CELLS_PER_OBSTACLE * obstacles.size(), MIN_CELLS, MAX_CELLS);
+        cell_size = std::sqrt(x_max * y_max / cells);
+    }
+    // Clamped so that a tiny cell size cannot exhaust the memory
+    nx = static_cast<int>(std::clamp(std::ceil(x_max / cell_size), 1.0, std::sqrt(MAX_CELLS) * 4));
+    ny = static_cast<int>(std::clamp(std::ceil(y_max / cell_size), 1.0, MAX_CELLS / nx));
+    cell_w = x_max / nx;
+    cell_h = y_max / ny;
+    size_t num_cells = static_cast<size_t>(nx) * ny;
+    size_t num_words = (num_cells + 63) / 64;
+    occupied.assign(num_words, 0);
+    boundary.assign(num_words, 0);
+
+    // Cells are classified as if they were slightly larger, so that a point sent to a neighboring cell by the
+    // rounding of the cell index still gets the right answer
+    const double pad = 1e-9 * std::max(x_max, y_max);
+    std::vector<std::pair<uint32_t, uint32_t>> touching; // (cell, obstacle) pairs, for the cells partly covered
+    for (size_t k = 0; k < obstacles.size(); ++k) {
+        const Obstacle& obs = obstacles[k];
+        double x0 = obs.ll_corner.x, x1 = obs.ll_corner.x + obs.lx;
+        double y0 = obs.ll_corner.y, y1 = obs.ll_corner.y + obs.ly;
+        int ix0 = std::clamp(static_cast<int>(std::floor((x0 - pad) / cell_w)), 0, nx - 1);
+        int ix1 = std::clamp(static_cast<int>(std::floor((x1 + pad) / cell_w)), 0, nx - 1);
+        int iy0 = std::clamp(static_cast<int>(std::floor((y0 - pad) / cell_h)), 0, ny - 1);
+        int iy1 = std::clamp(static_cast<int>(std::floor((y1 + pad) / cell_h)), 0, ny - 1);
+        for (int iy = iy0; iy <= iy1; ++iy) {
+            bool inside_y = iy * cell_h - pad >= y0 && (iy + 1) * cell_h + pad <= y1;
+            for (int ix = ix0; ix <= ix1; ++ix) {
+                size_t c = static_cast<size_t>(iy) * nx + ix;
+                if (inside_y && ix * cell_w - pad >= x0 && (ix + 1) * cell_w + pad <= x1) {
+                    occupied[c >> 6] |= 1ull << (c & 63);
+                } else {
+                    touching.emplace_back(c, k);
+                }
+            }
+        }
+    }
+
+    // A cell covered by one obstacle needs no list, whatever else touches it
+    for (const auto& [c, k] : touching) {
+        if (!(occupied[c >> 6] & (1ull << (c & 63)))) {
+            boundary[c >> 6] |= 1ull << (c & 63);
+        }
+    }
+    boundary_rank.assign(num_words, 0);
+    uint32_t num_boundary = 0;
+    for (size_t w = 0; w < num_words; ++w) {
+        boundary_rank[w] = num_boundary;
+        num_boundary += __builtin_popcountll(boundary[w]);
+    }
+
+    // Two passes (count, then fill) to lay the lists out contiguously, by rank of the boundary cell
+    auto rank = [&](size_t c) {
+        return boundary_rank[c >> 6] + __builtin_popcountll(boundary[c >> 6] & ((1ull << (c & 63)) - 1));
+    };
+    item_start.assign(num_boundary + 1, 0);
+    for (const auto& [c, k] : touching) {
+        if (boundary[c >> 6] & (1ull << (c & 63))) {
+            item_start[rank(c) + 1]++;
+        }
+    }
+    for (uint32_t r = 0; r < num_boundary; ++r) {
+        item_start[r + 1] += item_start[r];
+    }
+    items.assign(item_start.back(), 0);
+    std::vector<uint32_t> fill(item_start.begin(), item_start.end() - 1);
+    for (const auto& [c, k] : touching) {
+        if (boundary[c >> 6] & (1ull << (c & 63))) {
+            items[fill[rank(c)]++] = k;
+        }
+    }
+}
+
+void OccupancyMap::clear() {
+    nx = ny = 0;
+    occupied.clear();
+    boundary.clear();
+    boundary_rank.clear();
+    item_start.clear();
+    items.clear();
+}
+
+bool OccupancyMap::contains(const Point& p, const std::vector<Obstacle>& obstacles) const {
+    if (!(p.x >= 0.0 && p.x <= x_max && p.y >= 0.0 && p.y <= y_max)) {
+        return pointInObstacles(p, obstacles); // Outside the map, which holds only for obstacles that overlap it
+    }
+    size_t c = static_cast<size_t>(std::min(static_cast<int>(p.y / cell_h), ny - 1)) * nx + std::min(static_cast<int>(p.x / cell_w), nx - 1);
+    uint64_t bit = 1ull << (c & 63);
+    if (occupied[c >> 6] & bit) {
+        return true;
+    }
+    if (!(boundary[c >> 6] & bit)) {
+        return false;
+    }
+    uint32_t r = boundary_rank[c >> 6] + __builtin_popcountll(boundary[c >> 6] & (bit - 1));
+    for (uint32_t i = item_start[r]; i < item_start[r + 1]; ++i) {
+        if (pointInObstacle(p, obstacles[items[i]])) {
+            return true;
+        }
+    }
+    return false;
+}
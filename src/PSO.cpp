@@ -2,383 +2,198 @@
 #include <utility>
 #include <math.h>
 #include <functional>
+#include <algorithm>
 
 #include "PSO.hpp"
+#include "PSOEngine.hpp"
 #include "Problem.hpp"
 #include "utils.hpp"
 
 // CONSTANTS
 const double INF = 1e9;
 
-Particle::Particle(const Problem& problem, int num_waypoints) : best_cost(INF), stagnation_counter(0) {
+Swarm::Swarm(int _num_particles, int _num_waypoints)
+    : num_particles(_num_particles), num_waypoints(_num_waypoints),
+      best_cost(_num_particles, INF), stagnation_counter(_num_particles, 0),
+      arena(6 * static_cast<size_t>(_num_particles) * _num_waypoints, 0.0) {
+}
+
+void Swarm::randomize(int i, const Problem& problem, RandomStream& rng) {
     // Initialize waypoints randomly within the environment bounds
-    for (int i = 0; i < num_waypoints; ++i) {
-        double x = static_cast<double>(rand()) / RAND_MAX * problem.x_max;
-        double y = static_cast<double>(rand()) / RAND_MAX * problem.y_max;
-        waypoints.emplace_back(x, y);
-        velocity.emplace_back(0.0, 0.0); // Start with zero velocity
+    for (int j = 0; j < num_waypoints; ++j) {
+        x(i)[j] = rng.uniform() * problem.x_max;
+        y(i)[j] = rng.uniform() * problem.y_max;
+        vx(i)[j] = 0.0; // Start with zero velocity
+        vy(i)[j] = 0.0;
+    }
+    // Initialize the personal best to the current waypoints
+    saveBest(i);
+    best_cost[i] = INF;
+    stagnation_counter[i] = 0;
+}
+
+void Swarm::saveBest(int i) {
+    std::copy(x(i), x(i) + num_waypoints, best_x(i));
+    std::copy(y(i), y(i) + num_waypoints, best_y(i));
+}
+
+void Swarm::copyPosition(int i, std::vector<Point>& out) const {
+    out.resize(num_waypoints);
+    for (int j = 0; j < num_waypoints; ++j) {
+        out[j].x = x(i)[j];
+        out[j].y = y(i)[j];
     }
-    // Initialize best_waypoints to current waypoints
-    best_waypoints = waypoints;
 }
 
-PSO::PSO(const Problem& problem, int num_particles, int num_waypoints) : global_best_cost(INF) {
-    // Initialize particles
+void Swarm::copyBest(int i, std::vector<Point>& out) const {
+    out.resize(num_waypoints);
+    for (int j = 0; j < num_waypoints; ++j) {
+        out[j].x = best_x(i)[j];
+        out[j].y = best_y(i)[j];
+    }
+}
+
+PSO::PSO(const Problem& problem, int num_particles, int num_waypoints, int num_threads, uint64_t seed)
+    : swarm(num_particles, num_waypoints), global_best_cost(INF), rng(seed, streamId(StreamDomain::PSO, 0)) {
+    if (num_threads > 1) {
+        pool = std::make_unique<ThreadPool>(num_threads);
+    }
+    scratch.resize(pool ? pool->size() : 1);
+    costs.resize(num_particles);
+    random_coefficients.resize(2 * static_cast<size_t>(num_particles) * num_waypoints);
+
+    // Initialize particles, each with its own random stream
     for (int i = 0; i < num_particles; ++i) {
-        particles.emplace_back(problem, num_waypoints); // emplace_back constructs a Particle in place using its constructor
+        particle_rngs.emplace_back(seed, streamId(StreamDomain::PSO_PARTICLE, i));
+        swarm.randomize(i, problem, particle_rngs[i]);
     }
     // Initialize global_best_waypoints with the first particle's waypoints
-    if (!particles.empty()) {
-        global_best_waypoints = particles[0].waypoints;
+    if (num_particles > 0) {
+        swarm.copyPosition(0, global_best_waypoints);
     }
 }
 
+template <typename FitnessFn>
 std::pair<std::vector<Point>, double> PSO::optimize(const Problem& problem, int num_iterations,
-    double c1, double c2, double w,  std::function<double(const std::vector<Point>&, const Problem&)> fitness) {
-    // Ensure global_best_waypoints is initialized
-    if (global_best_waypoints.empty() && !particles.empty()) {
-        global_best_waypoints = particles[0].waypoints;
-    }
-    for (int iter = 0; iter < num_iterations; ++iter) {
-        for (auto& particle : particles) {
-            // Update particle's best known position
-            double cost = fitness(particle.waypoints, problem);
-            if (cost < particle.best_cost) {
-                particle.best_cost = cost;
-                particle.best_waypoints = particle.waypoints;
-            }
-
-            // Update global best position
-            if (cost < global_best_cost) {
-                global_best_cost = cost;
-                global_best_waypoints = particle.waypoints;
-            }
-        }
-
-        // Update velocities and positions of particles
-        for (auto& particle : particles) {
-            for (size_t i = 0; i < particle.waypoints.size(); ++i) {
-                // Update velocity based on local and global bests
-                double r1 = static_cast<double>(rand()) / RAND_MAX; // random in [0, 1]
-                double r2 = static_cast<double>(rand()) / RAND_MAX; // random in [0, 1]
-
-                particle.velocity[i].x = w * particle.velocity[i].x +
-                                        c1 * r1 * (particle.best_waypoints[i].x - particle.waypoints[i].x) +
-                                        c2 * r2 * (global_best_waypoints[i].x - particle.waypoints[i].x);
-
-                particle.velocity[i].y = w * particle.velocity[i].y +
-                                        c1 * r1 * (particle.best_waypoints[i].y - particle.waypoints[i].y) +
-                                        c2 * r2 * (global_best_waypoints[i].y - particle.waypoints[i].y);
-
-                // Update position
-                particle.waypoints[i].x += particle.velocity[i].x;
-                particle.waypoints[i].y += particle.velocity[i].y;
-
-                // Ensure waypoints are within bounds of the environment
-                particle.waypoints[i].x = std::max(0.0, std::min(particle.waypoints[i].x, problem.x_max));
-                particle.waypoints[i].y = std::max(0.0, std::min(particle.waypoints[i].y, problem.y_max));
-            }
-        }
-    }
-    return {global_best_waypoints, global_best_cost};
+    double c1, double c2, double w, const typename NonDeduced<FitnessFn>::type& fitness) {
+    return PSOEngine<FitnessFn>(*this, problem, c1, c2, w, fitness).run(num_iterations);
 }
 
 /*
 This variant includes random restarts.
 */
+template <typename FitnessFn>
 std::pair<std::vector<Point>, double> PSO::optimize_with_random_restart(const Problem& problem, int num_iterations,
-    double c1, double c2, double w, int restart_interval, std::function<double(const std::vector<Point>&, const Problem&)> fitness) {
-    int num_particles = particles.size();
-    std::vector<Point> final_best_waypoints = global_best_waypoints;
-    double final_best_cost = global_best_cost;
-
-    // Ensure global_best_waypoints is initialized
-    if (global_best_waypoints.empty() && !particles.empty()) {
-        global_best_waypoints = particles[0].waypoints;
-    }
-
-    for (int iter = 0; iter < num_iterations; ++iter) {
-        if (iter > 0 && iter % restart_interval == 0) {
-            // Randomly reinitialize particles
-            particles.clear();
-            for (int i = 0; i < num_particles; ++i) {
-                particles.emplace_back(problem, global_best_waypoints.size());
-            }
-            // Update final best if current global best is better
-            if (final_best_cost > global_best_cost) {
-                final_best_cost = global_best_cost;
-                final_best_waypoints = global_best_waypoints;
-            }
-            // Reset global best for the new set of particles
-            global_best_cost = INF;
-            if (!particles.empty()) {
-                global_best_waypoints = particles[0].waypoints;
-            }
-        }
-
-        for (auto& particle : particles) {
-            // Update particle's best known position
-            double cost = fitness(particle.waypoints, problem);
-            if (cost < particle.best_cost) {
-                particle.best_cost = cost;
-                particle.best_waypoints = particle.waypoints;
-            }
-
-            // Update global best position
-            if (cost < global_best_cost) {
-                global_best_cost = cost;
-                global_best_waypoints = particle.waypoints;
-            }
-        }
-
-        // Update velocities and positions of particles
-        for (auto& particle : particles) {
-            for (size_t i = 0; i < particle.waypoints.size(); ++i) {
-                // Update velocity based on local and global bests
-                double r1 = static_cast<double>(rand()) / RAND_MAX; // random in [0, 1]
-                double r2 = static_cast<double>(rand()) / RAND_MAX; // random in [0, 1]
-
-                particle.velocity[i].x = w * particle.velocity[i].x +
-                                        c1 * r1 * (particle.best_waypoints[i].x - particle.waypoints[i].x) +
-                                        c2 * r2 * (global_best_waypoints[i].x - particle.waypoints[i].x);
-
-                particle.velocity[i].y = w * particle.velocity[i].y +
-                                        c1 * r1 * (particle.best_waypoints[i].y - particle.waypoints[i].y) +
-                                        c2 * r2 * (global_best_waypoints[i].y - particle.waypoints[i].y);
-
-                // Update position
-                particle.waypoints[i].x += particle.velocity[i].x;
-                particle.waypoints[i].y += particle.velocity[i].y;
-
-                // Ensure waypoints are within bounds of the environment
-                particle.waypoints[i].x = std::max(0.0, std::min(particle.waypoints[i].x, problem.x_max));
-                particle.waypoints[i].y = std::max(0.0, std::min(particle.waypoints[i].y, problem.y_max));
-            }
-        }
-    }
-    return {final_best_waypoints, final_best_cost};
+    double c1, double c2, double w, int restart_interval, const typename NonDeduced<FitnessFn>::type& fitness) {
+    PSOEngine<FitnessFn, PeriodicRestart> engine(*this, problem, c1, c2, w, fitness, PeriodicRestart{restart_interval});
+    return engine.run(num_iterations);
 }
 
 /*
 This variant includes random restarts and annealing
 */
+template <typename FitnessFn>
 std::pair<std::vector<Point>, double> PSO::optimize_with_annealing(const Problem& problem, int num_iterations,
-    double c1, double c2, double w, int restart_interval, double initial_temp, double cooling_rate, 
-    std::function<double(const std::vector<Point>&, const Problem&)> fitness) {
-    double temperature = initial_temp;
-    int num_particles = particles.size();
-    std::vector<Point> final_best_waypoints = global_best_waypoints;
-    double final_best_cost = global_best_cost;
-
-    // Ensure global_best_waypoints is initialized
-    if (global_best_waypoints.empty() && !particles.empty()) {
-        global_best_waypoints = particles[0].waypoints;
-    }
-
-    for (int iter = 0; iter < num_iterations; ++iter) {
-        // Random restart logic
-        if (iter > 0 && iter % restart_interval == 0) {
-            // Randomly reinitialize particles
-            particles.clear();
-            for (int i = 0; i < num_particles; ++i) {
-                particles.emplace_back(problem, global_best_waypoints.size());
-            }
-            // Update final best if current global best is better
-            if (final_best_cost > global_best_cost) {
-                final_best_cost = global_best_cost;
-                final_best_waypoints = global_best_waypoints;
-            }
-            // Reset global best for the new set of particles
-            global_best_cost = INF;
-            if (!particles.empty()) {
-                global_best_waypoints = particles[0].waypoints;
-            }
-        }
-
-        for (auto& particle : particles) {
-            // Update particle's best known position
-            double cost = fitness(particle.waypoints, problem);
-            if (cost < particle.best_cost) {
-                particle.best_cost = cost;
-                particle.best_waypoints = particle.waypoints;
-            }
-
-            // Update global best position
-            if (cost < global_best_cost) {
-                global_best_cost = cost;
-                global_best_waypoints = particle.waypoints;
-            }
-
-            // Annealing acceptance criterion
-            if (cost > global_best_cost) {
-                double acceptance_prob = std::min(1.0, exp(-(cost - global_best_cost) / temperature));
-                if (static_cast<double>(rand()) / RAND_MAX < acceptance_prob) {
-                    global_best_cost = cost;
-                    global_best_waypoints = particle.waypoints; 
-                }
-            }
-        }
-        
-
-        // Update velocities and positions of particles
-        for (auto& particle : particles) {
-            for (size_t i = 0; i < particle.waypoints.size(); ++i) {
-                // Update velocity based on local and global bests
-                double r1 = static_cast<double>(rand()) / RAND_MAX; // random in [0, 1]
-                double r2 = static_cast<double>(rand()) / RAND_MAX; // random in [0, 1]
-
-                particle.velocity[i].x = w * particle.velocity[i].x +
-                                        c1 * r1 * (particle.best_waypoints[i].x - particle.waypoints[i].x) +
-                                        c2 * r2 * (global_best_waypoints[i].x - particle.waypoints[i].x);
-
-                particle.velocity[i].y = w * particle.velocity[i].y +
-                                        c1 * r1 * (particle.best_waypoints[i].y - particle.waypoints[i].y) +
-                                        c2 * r2 * (global_best_waypoints[i].y - particle.waypoints[i].y);
-
-                // Update position
-                particle.waypoints[i].x += particle.velocity[i].x;
-                particle.waypoints[i].y += particle.velocity[i].y;
-
-                // Ensure waypoints are within bounds of the environment
-                particle.waypoints[i].x = std::max(0.0, std::min(particle.waypoints[i].x, problem.x_max));
-                particle.waypoints[i].y = std::max(0.0, std::min(particle.waypoints[i].y, problem.y_max));
-            }
-        }
-
-        // Temperature update
-        temperature = temperature * cooling_rate; 
-    }
-
-    // Final check to update best solution after the last iteration
-    if (final_best_cost > global_best_cost) {
-        final_best_cost = global_best_cost;
-        final_best_waypoints = global_best_waypoints;
-    }
-        
-    
-    return {final_best_waypoints, final_best_cost};
+    double c1, double c2, double w, int restart_interval, double initial_temp, double cooling_rate,
+    const typename NonDeduced<FitnessFn>::type& fitness) {
+    PSOEngine<FitnessFn, PeriodicRestart, AnnealingAcceptance> engine(*this, problem, c1, c2, w, fitness, PeriodicRestart{restart_interval},
+        AnnealingAcceptance{initial_temp, cooling_rate});
+    return engine.run(num_iterations);
 }
 
 /*
 This variant includes random restarts, annealing, and dimensional learning
 */
+template <typename FitnessFn>
 std::pair<std::vector<Point>, double> PSO::optimize_with_dimensional_learning(const Problem& problem, int num_iterations,
     double c1, double c2, double w, int restart_interval, double initial_temp, double cooling_rate, int stagnation_threshold,
-    std::function<double(const std::vector<Point>&, const Problem&)> fitness) {
-    double temperature = initial_temp;
-    int num_particles = particles.size();
-    std::vector<Point> final_best_waypoints = global_best_waypoints;
-    double final_best_cost = global_best_cost;
-
-    // Ensure global_best_waypoints is initialized
-    if (global_best_waypoints.empty() && !particles.empty()) {
-        global_best_waypoints = particles[0].waypoints;
-    }
+    const typename NonDeduced<FitnessFn>::type& fitness) {
+    PSOEngine<FitnessFn, PeriodicRestart, AnnealingAcceptance, DimensionalLearning> engine(*this, problem, c1, c2, w, fitness,
+        PeriodicRestart{restart_interval}, AnnealingAcceptance{initial_temp, cooling_rate}, DimensionalLearning{stagnation_threshold});
+    return engine.run(num_iterations);
+}
 
-    for (int iter = 0; iter < num_iterations; ++iter) {
-        // Random restart logic
-        if (iter > 0 && iter % restart_interval == 0) {
-            // Randomly reinitialize particles
-            particles.clear();
-            for (int i = 0; i < num_particles; ++i) {
-                particles.emplace_back(problem, global_best_waypoints.size());
-            }
-            // Update final best if current global best is better
-            if (final_best_cost > global_best_cost) {
-                final_best_cost = global_best_cost;
-                final_best_waypoints = global_best_waypoints;
-            }
-            // Reset global best for the new set of particles
-            global_best_cost = INF;
-            if (!particles.empty()) {
-                global_best_waypoints = particles[0].waypoints;
-            }
-        }
+std::pair<std::vector<Point>, double> PSO::optimize(const Problem& problem, int num_iterations,
+    double c1, double c2, double w, FitnessFunction fitness) {
+    return optimize<FitnessFunction>(problem, num_iterations, c1, c2, w, fitness);
+}
 
-        for (auto& particle : particles) {
-            // Update particle's best known position
-            double cost = fitness(particle.waypoints, problem);
-            if (cost < particle.best_cost) {
-                particle.best_cost = cost;
-                particle.best_waypoints = particle.waypoints;
-                particle.stagnation_counter = 0; // Reset stagnation counter on improvement
-            } else {
-                particle.stagnation_counter++; // Increment stagnation counter if no improvement
-            }
-
-            // Update global best position
-            if (cost < global_best_cost) {
-                global_best_cost = cost;
-                global_best_waypoints = particle.waypoints;
-            }
-
-            // Annealing acceptance criterion
-            if (cost > global_best_cost) {
-                double acceptance_prob = std::min(1.0, exp(-(cost - global_best_cost) / temperature));
-                if (static_cast<double>(rand()) / RAND_MAX < acceptance_prob) {
-                    global_best_cost = cost;
-                    global_best_waypoints = particle.waypoints; 
-                }
-            }
-
-            // Dimensional learning: If the particle has stagnated, update its local best coordinate by coordinate
-            if (particle.stagnation_counter >= stagnation_threshold) {
-                for (std::size_t j=0; j < particle.waypoints.size(); ++j) {
-                    // Create a new candidate by replacing the j-th coordinate with the global best
-                    Point candidate_waypoint = particle.best_waypoints[j];
-                    particle.best_waypoints[j] = global_best_waypoints[j];
-
-                    double candidate_cost = fitness(particle.best_waypoints, problem);
-                    if (candidate_cost < particle.best_cost) {
-                        particle.best_cost = candidate_cost;
-                        particle.best_waypoints = particle.best_waypoints;
-                    } else {
-                        // Revert the change if it doesn't improve
-                        particle.best_waypoints[j] = candidate_waypoint;
-                    }
-                }
-                particle.stagnation_counter = 0; // Reset stagnation counter after learning
-            }
-        }
-        
-
-        // Update velocities and positions of particles
-        for (auto& particle : particles) {
-            for (size_t i = 0; i < particle.waypoints.size(); ++i) {
-                // Update velocity based on local and global bests
-                double r1 = static_cast<double>(rand()) / RAND_MAX; // random in [0, 1]
-                double r2 = static_cast<double>(rand()) / RAND_MAX; // random in [0, 1]
-
-                particle.velocity[i].x = w * particle.velocity[i].x +
-                                        c1 * r1 * (particle.best_waypoints[i].x - particle.waypoints[i].x) +
-                                        c2 * r2 * (global_best_waypoints[i].x - particle.waypoints[i].x);
-
-                particle.velocity[i].y = w * particle.velocity[i].y +
-                                        c1 * r1 * (particle.best_waypoints[i].y - particle.waypoints[i].y) +
-                                        c2 * r2 * (global_best_waypoints[i].y - particle.waypoints[i].y);
-
-                // Update position
-                particle.waypoints[i].x += particle.velocity[i].x;
-                particle.waypoints[i].y += particle.velocity[i].y;
-
-                // Ensure waypoints are within bounds of the environment
-                particle.waypoints[i].x = std::max(0.0, std::min(particle.waypoints[i].x, problem.x_max));
-                particle.waypoints[i].y = std::max(0.0, std::min(particle.waypoints[i].y, problem.y_max));
-            }
+std::pair<std::vector<Point>, double> PSO::optimize_with_random_restart(const Problem& problem, int num_iterations,
+    double c1, double c2, double w, int restart_interval, FitnessFunction fitness) {
+    return optimize_with_random_restart<FitnessFunction>(problem, num_iterations, c1, c2, w, restart_interval, fitness);
+}
+
+std::pair<std::vector<Point>, double> PSO::optimize_with_annealing(const Problem& problem, int num_iterations,
+    double c1, double c2, double w, int restart_interval, double initial_temp, double cooling_rate, FitnessFunction fitness) {
+    return optimize_with_annealing<FitnessFunction>(problem, num_iterations, c1, c2, w, restart_interval, initial_temp, cooling_rate, fitness);
+}
+
+std::pair<std::vector<Point>, double> PSO::optimize_with_dimensional_learning(const Problem& problem, int num_iterations,
+    double c1, double c2, double w, int restart_interval, double initial_temp, double cooling_rate, int stagnation_threshold, FitnessFunction fitness) {
+    return optimize_with_dimensional_learning<FitnessFunction>(problem, num_iterations, c1, c2, w, restart_interval, initial_temp, cooling_rate,
+        stagnation_threshold, fitness);
+}
+
+// Instantiations of the optimizers for the fitness policies declared in PSO.hpp
+#define INSTANTIATE_OPTIMIZERS(FitnessFn) \
+    template std::pair<std::vector<Point>, double> PSO::optimize<FitnessFn>(const Problem&, int, double, double, double, const FitnessFn&); \
+    template std::pair<std::vector<Point>, double> PSO::optimize_with_random_restart<FitnessFn>(const Problem&, int, double, double, double, int, \
+        const FitnessFn&); \
+    template std::pair<std::vector<Point>, double> PSO::optimize_with_annealing<FitnessFn>(const Problem&, int, double, double, double, int, \
+        double, double, const FitnessFn&); \
+    template std::pair<std::vector<Point>, double> PSO::optimize_with_dimensional_learning<FitnessFn>(const Problem&, int, double, double, double, \
+        int, double, double, int, const FitnessFn&);
+
+INSTANTIATE_OPTIMIZERS(Fitness)
+INSTANTIATE_OPTIMIZERS(FitnessRefined)
+INSTANTIATE_OPTIMIZERS(FitnessFunction)
+
+void PSO::updateParticles(const Problem& problem, double c1, double c2, double w) {
+    const int num_waypoints = swarm.num_waypoints;
+    forEachParticle([&](int k, int) {
+        // Each particle draws its coefficients in one batch from its own stream, so the draws do not depend on the thread running it
+        double* r = random_coefficients.data() + 2 * static_cast<size_t>(k) * num_waypoints;
+        particle_rngs[k].fillUniform(r, 2 * num_waypoints);
+
+        double* x = swarm.x(k);
+        double* y = swarm.y(k);
+        double* vx = swarm.vx(k);
+        double* vy = swarm.vy(k);
+        const double* best_x = swarm.best_x(k);
+        const double* best_y = swarm.best_y(k);
+        for (int i = 0; i < num_waypoints; ++i) {
+            // Update velocity based on local and global bests
+            double r1 = r[2 * i];
+            double r2 = r[2 * i + 1];
+
+            vx[i] = w * vx[i] +
+                    c1 * r1 * (best_x[i] - x[i]) +
+                    c2 * r2 * (global_best_waypoints[i].x - x[i]);
+
+            vy[i] = w * vy[i] +
+                    c1 * r1 * (best_y[i] - y[i]) +
+                    c2 * r2 * (global_best_waypoints[i].y - y[i]);
+
+            // Update position
+            x[i] += vx[i];
+            y[i] += vy[i];
+
+            // Ensure waypoints are within bounds of the environment
+            x[i] = std::max(0.0, std::min(x[i], problem.x_max));
+            y[i] = std::max(0.0, std::min(y[i], problem.y_max));
         }
+    });
+}
 
-        // Temperature update
-        temperature = temperature * cooling_rate; 
+void PSO::restartParticles(const Problem& problem) {
+    for (int k = 0; k < swarm.num_particles; ++k) {
+        swarm.randomize(k, problem, particle_rngs[k]); // The streams carry on, so the new particles differ from the initial ones
     }
-
-    // Final check to update best solution after the last iteration
-    if (final_best_cost > global_best_cost) {
-        final_best_cost = global_best_cost;
-        final_best_waypoints = global_best_waypoints;
+    // Reset global best for the new set of particles
+    global_best_cost = INF;
+    if (swarm.num_particles > 0) {
+        swarm.copyPosition(0, global_best_waypoints);
     }
-        
-    
-    return {final_best_waypoints, final_best_cost};
 }
 
 /*
@@ -392,7 +207,7 @@ double fitness(const std::vector<Point>& waypoints, const Problem& problem) {
 
     // Check for collisions
     if (problem.isCollision(waypoints)) {
-        total_distance += INF; // Penalize paths that collide with obstacles
+        total_distance += COLLISION_PENALTY; // Penalize paths that collide with obstacles
     }
 
     // Calculate total path length
@@ -419,5 +234,5 @@ double fitness_refined(const std::vector<Point>& waypoints, const Problem& probl
     }
     total_distance += euclideanDistance(current, problem.goal1);
 
-    return total_distance + 1e6 * problem.collisionDistance(waypoints); 
+    return total_distance + PENETRATION_WEIGHT * problem.collisionDistance(waypoints);
 }
\ No newline at end of file
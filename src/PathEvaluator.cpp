@@ -0,0 +1,142 @@
+#include "PathEvaluator.hpp"
+#include "utils.hpp"
+
+// CONSTANTS
+const double UNKNOWN = -1.0; // Penalty of a segment not tested for collision yet
+
+PathEvaluator::PathEvaluator(PathCost _model) : model(_model) {
+}
+
+double PathEvaluator::segmentPenalty(const Point& p1, const Point& p2, const Problem& problem) const {
+    if (model == PathCost::COLLISION_PENALTY) {
+        return UNKNOWN; // Only tested when needed, see collides()
+    }
+    if (points.size() < 2) {
+        return 0.0; // Like Problem::collisionDistance, which ignores paths with fewer than 2 waypoints
+    }
+    return problem.collisionDistance(p1, p2);
+}
+
+double PathEvaluator::evaluate(const std::vector<Point>& waypoints, const Problem& problem) {
+    points = waypoints;
+    int n = points.size();
+    lengths.resize(n + 1);
+    penalties.resize(n + 1);
+    for (int s = 0; s <= n; ++s) {
+        const Point& p1 = s == 0 ? problem.start1 : points[s - 1];
+        const Point& p2 = s == n ? problem.goal1 : points[s];
+        lengths[s] = euclideanDistance(p1, p2);
+        penalties[s] = segmentPenalty(p1, p2, problem);
+    }
+    pending_j = -1;
+    current_cost = total(-1, problem);
+    return current_cost;
+}
+
+double PathEvaluator::tryMove(int j, const Point& p, const Problem& problem) {
+    int n = points.size();
+    const Point& before = j == 0 ? problem.start1 : points[j - 1];
+    const Point& after = j == n - 1 ? problem.goal1 : points[j + 1];
+    pending_j = j;
+    pending_point = p;
+    pending_lengths[0] = euclideanDistance(before, p);
+    pending_lengths[1] = euclideanDistance(p, after);
+    pending_penalties[0] = segmentPenalty(before, p, problem);
+    pending_penalties[1] = segmentPenalty(p, after, problem);
+    pending_cost = total(j, problem);
+    return pending_cost;
+}
+
+void PathEvaluator::commitMove() {
+    if (pending_j < 0) {
+        return;
+    }
+    points[pending_j] = pending_point;
+    lengths[pending_j] = pending_lengths[0];
+    lengths[pending_j + 1] = pending_lengths[1];
+    penalties[pending_j] = pending_penalties[0];
+    penalties[pending_j + 1] = pending_penalties[1];
+    current_cost = pending_cost;
+    pending_j = -1;
+}
+
+bool PathEvaluator::collides(int moved, const Problem& problem) {
+    int n = points.size();
+    if (n < 2) {
+        return false; // Like Problem::isCollision, which ignores paths with fewer than 2 waypoints
+    }
+    auto penalty = [&](int s) -> double& {
+        if (moved >= 0 && (s == moved || s == moved + 1)) {
+            return pending_penalties[s - moved];
+        }
+        return penalties[s];
+    };
+    auto point = [&](int i) -> const Point& {
+        if (i < 0) {
+            return problem.start1;
+        }
+        if (i == n) {
+            return problem.goal1;
+        }
+        return i == moved ? pending_point : points[i];
+    };
+
+    // A collision already known decides without any new test, otherwise the untested segments are tested until one collides
+    for (int s = 0; s <= n; ++s) {
+        if (penalty(s) > 0.0) {
+            return true;
+        }
+    }
+    for (int s = 0; s <= n; ++s) {
+        double& flag = penalty(s);
+        if (flag == UNKNOWN) {
+            flag = problem.isCollision(point(s - 1), point(s)) ? 1.0 : 0.0;
+            if (flag > 0.0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+double PathEvaluator::total(int moved, const Problem& problem) {
+    int n = points.size();
+    auto length = [&](int s) {
+        if (moved >= 0 && (s == moved || s == moved + 1)) {
+            return pending_lengths[s - moved];
+        }
+        return lengths[s];
+    };
+    auto penalty = [&](int s) {
+        if (moved >= 0 && (s == moved || s == moved + 1)) {
+            return pending_penalties[s - moved];
+        }
+        return penalties[s];
+    };
+
+    // Same operations, in the same order, as fitness() and fitness_refined()
+    double total_distance = 0.0;
+    if (model == PathCost::COLLISION_PENALTY) {
+        if (collides(moved, problem)) {
+            total_distance += COLLISION_PENALTY;
+        }
+        for (int s = 0; s <= n; ++s) {
+            total_distance += length(s);
+        }
+        return total_distance;
+    }
+
+    for (int s = 0; s <= n; ++s) {
+        total_distance += length(s);
+    }
+    // Problem::collisionDistance sums the inner segments first, then the segments from the start and to the goal
+    double collision_distance = 0.0;
+    if (n >= 2) {
+        for (int s = 1; s < n; ++s) {
+            collision_distance += penalty(s);
+        }
+        collision_distance += penalty(0);
+        collision_distance += penalty(n);
+    }
+    return total_distance + PENETRATION_WEIGHT * collision_distance;
+}
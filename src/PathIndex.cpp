@@ -0,0 +1,153 @@
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "PathIndex.hpp"
+#include "Problem.hpp"
+#include "utils.hpp"
+
+// CONSTANTS
+const int MAX_CELLS_PER_AXIS = 256;
+
+void PathIndex::build(const std::vector<Point>& path) {
+    points = path;
+    arc_length.assign(points.size(), 0.0);
+    for (size_t i = 1; i < points.size(); ++i) {
+        arc_length[i] = arc_length[i - 1] + euclideanDistance(points[i - 1], points[i]); // Same order as a scan of the path
+    }
+    cell_start.clear();
+    cell_items.clear();
+    first_cell_x.clear();
+    first_cell_y.clear();
+    nx = ny = 0;
+    if (empty()) {
+        return;
+    }
+
+    x0 = x1 = points[0].x;
+    y0 = y1 = points[0].y;
+    for (const Point& p : points) {
+        x0 = std::min(x0, p.x);
+        x1 = std::max(x1, p.x);
+        y0 = std::min(y0, p.y);
+        y1 = std::max(y1, p.y);
+    }
+
+    // Aim for about one segment per cell, keeping cells roughly square (a straight path still gets one row or column)
+    const int num_segments = points.size() - 1;
+    const double pad = 1e-9 * std::max({x1 - x0, y1 - y0, 1.0});
+    const double w = std::max(x1 - x0, pad), h = std::max(y1 - y0, pad);
+    nx = std::clamp(static_cast<int>(std::ceil(std::sqrt(num_segments * w / h))), 1, MAX_CELLS_PER_AXIS);
+    ny = std::clamp(static_cast<int>(std::ceil(std::sqrt(num_segments * h / w))), 1, MAX_CELLS_PER_AXIS);
+    cell_w = w / nx;
+    cell_h = h / ny;
+
+    // Segments are registered in every cell their bounding box touches, two passes to lay the cell lists out contiguously
+    std::vector<int> count(nx * ny, 0);
+    first_cell_x.resize(num_segments);
+    first_cell_y.resize(num_segments);
+    auto segmentCells = [&](int i, int& ix0, int& ix1, int& iy0, int& iy1) {
+        const Point& a = points[i];
+        const Point& b = points[i + 1];
+        cellRange(std::min(a.x, b.x), std::max(a.x, b.x), std::min(a.y, b.y), std::max(a.y, b.y), ix0, ix1, iy0, iy1);
+    };
+    for (int i = 0; i < num_segments; ++i) {
+        int ix0, ix1, iy0, iy1;
+        segmentCells(i, ix0, ix1, iy0, iy1);
+        first_cell_x[i] = ix0;
+        first_cell_y[i] = iy0;
+        for (int iy = iy0; iy <= iy1; ++iy) {
+            for (int ix = ix0; ix <= ix1; ++ix) {
+                count[iy * nx + ix]++;
+            }
+        }
+    }
+    cell_start.assign(nx * ny + 1, 0);
+    for (int c = 0; c < nx * ny; ++c) {
+        cell_start[c + 1] = cell_start[c] + count[c];
+    }
+    cell_items.resize(cell_start.back());
+    std::vector<int> fill(cell_start.begin(), cell_start.end() - 1);
+    for (int i = 0; i < num_segments; ++i) {
+        int ix0, ix1, iy0, iy1;
+        segmentCells(i, ix0, ix1, iy0, iy1);
+        for (int iy = iy0; iy <= iy1; ++iy) {
+            for (int ix = ix0; ix <= ix1; ++ix) {
+                cell_items[fill[iy * nx + ix]++] = i;
+            }
+        }
+    }
+}
+
+void PathIndex::cellRange(double xmin, double xmax, double ymin, double ymax, int& ix0, int& ix1, int& iy0, int& iy1) const {
+    // Slightly inflated, so that an intersection found by rounding just outside a bounding box still lands in a shared cell
+    const double pad = 1e-9 * std::max({x1 - x0, y1 - y0, 1.0});
+    ix0 = std::clamp(static_cast<int>(std::floor((xmin - pad - x0) / cell_w)), 0, nx - 1);
+    ix1 = std::clamp(static_cast<int>(std::floor((xmax + pad - x0) / cell_w)), 0, nx - 1);
+    iy0 = std::clamp(static_cast<int>(std::floor((ymin - pad - y0) / cell_h)), 0, ny - 1);
+    iy1 = std::clamp(static_cast<int>(std::floor((ymax + pad - y0) / cell_h)), 0, ny - 1);
+}
+
+bool PathIndex::segmentConflicts(int i, const Point& p1, double t1, const Point& p2, double separation) const {
+    if (!segmentsIntersect(p1, p2, points[i], points[i + 1])) {
+        return false;
+    }
+    Point intersection_point;
+    getIntersectionPoint(p1, p2, points[i], points[i + 1], intersection_point);
+    return std::abs(euclideanDistance(p1, intersection_point) + t1 - (euclideanDistance(points[i], intersection_point) + arc_length[i])) < separation;
+}
+
+bool PathIndex::conflicts(const Point& p1, double t1, const Point& p2, double separation) const {
+    if (empty()) {
+        return false;
+    }
+
+    // The robot is on the edge during [t1, t1 + length], so only the segments travelled during that window widened by
+    // separation can conflict: those with arc_length[i + 1] > t_min and arc_length[i] < t_max
+    const double length = euclideanDistance(p1, p2);
+    const double slack = 1e-9 * (std::abs(t1) + length + arc_length.back()); // Rounding of the distances to the intersection
+    const double t_min = t1 - separation - slack;
+    const double t_max = t1 + length + separation + slack;
+    const int lo = std::upper_bound(arc_length.begin() + 1, arc_length.end(), t_min) - (arc_length.begin() + 1);
+    const int hi = std::lower_bound(arc_length.begin(), arc_length.end() - 1, t_max) - arc_length.begin();
+    if (lo >= hi) {
+        return false;
+    }
+
+    const double xmin = std::min(p1.x, p2.x), xmax = std::max(p1.x, p2.x);
+    const double ymin = std::min(p1.y, p2.y), ymax = std::max(p1.y, p2.y);
+    const double pad = 1e-9 * std::max({x1 - x0, y1 - y0, 1.0});
+    if (xmax < x0 - pad || xmin > x1 + pad || ymax < y0 - pad || ymin > y1 + pad) {
+        return false; // Away from the whole path
+    }
+    int ix0, ix1, iy0, iy1;
+    cellRange(xmin, xmax, ymin, ymax, ix0, ix1, iy0, iy1);
+
+    // Few segments in the time window: testing them directly is cheaper than visiting the cells
+    if (hi - lo <= (ix1 - ix0 + 1) * (iy1 - iy0 + 1)) {
+        for (int i = lo; i < hi; ++i) {
+            if (segmentConflicts(i, p1, t1, p2, separation)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // A segment listed in several cells of the range is tested only in the first of them, the cell where the lower
+    // corners of its range and of the query range meet
+    for (int iy = iy0; iy <= iy1; ++iy) {
+        for (int ix = ix0; ix <= ix1; ++ix) {
+            const int c = iy * nx + ix;
+            for (int k = cell_start[c]; k < cell_start[c + 1]; ++k) {
+                const int i = cell_items[k];
+                if (i < lo || i >= hi || std::max(first_cell_x[i], ix0) != ix || std::max(first_cell_y[i], iy0) != iy) {
+                    continue;
+                }
+                if (segmentConflicts(i, p1, t1, p2, separation)) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,237 @@
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "PathRefiner.hpp"
+
+// CONSTANTS
+const int MAX_SAMPLES_PER_SEGMENT = 256;
+const int WEIGHT_INCREASES = 3; // Times the weight is multiplied by WEIGHT_FACTOR when the refined path crosses an obstacle
+const double WEIGHT_FACTOR = 10.0;
+const double ARMIJO = 1e-4; // Sufficient decrease constant of the line search
+const int MAX_BACKTRACKS = 30;
+const double TOLERANCE = 1e-9; // Relative decrease of the cost below which the minimization stops
+
+PathRefiner::PathRefiner(const Problem& _problem, const DistanceField& _field, double _clearance, double _weight)
+    : clearance(_clearance), weight(_weight), problem(_problem), field(_field) {}
+
+double PathRefiner::evaluate(const std::vector<double>& x, const Point& start, const Point& goal, const std::vector<int>& samples,
+    double w, std::vector<double>* gradient) const {
+    const int n = x.size() / 2;
+    auto point = [&](int k) { return k == 0 ? start : k == n + 1 ? goal : Point(x[2 * (k - 1)], x[2 * (k - 1) + 1]); };
+    auto accumulate = [&](int k, double gx, double gy) { // Gradient with respect to point k, the endpoints being fixed
+        if (gradient && k >= 1 && k <= n) {
+            (*gradient)[2 * (k - 1)] += gx;
+            (*gradient)[2 * (k - 1) + 1] += gy;
+        }
+    };
+    if (gradient) {
+        gradient->assign(x.size(), 0.0);
+    }
+
+    double total = 0.0;
+    for (int s = 0; s <= n; ++s) {
+        Point a = point(s), b = point(s + 1);
+        double dx = b.x - a.x, dy = b.y - a.y;
+        double length = std::sqrt(dx * dx + dy * dy);
+
+        // Mean of the penalty over the samples, and its gradients with respect to a and b
+        int k = samples[s];
+        double mean = 0.0, ga_x = 0.0, ga_y = 0.0, gb_x = 0.0, gb_y = 0.0;
+        for (int j = 0; j < k; ++j) {
+            double t = (j + 0.5) / k;
+            Point p(a.x + t * dx, a.y + t * dy);
+            Point grad_d;
+            double d = field.distance(p, grad_d);
+            if (d >= clearance) {
+                continue;
+            }
+            mean += (clearance - d) * (clearance - d);
+            double slope = -2.0 * (clearance - d); // Derivative of the penalty with respect to d
+            ga_x += slope * grad_d.x * (1 - t);
+            ga_y += slope * grad_d.y * (1 - t);
+            gb_x += slope * grad_d.x * t;
+            gb_y += slope * grad_d.y * t;
+        }
+        mean /= k;
+        total += length + w * length * mean;
+
+        // Segment term length * (1 + w * mean)
+        if (gradient) {
+            double ux = length > 0.0 ? dx / length : 0.0, uy = length > 0.0 ? dy / length : 0.0;
+            double factor = 1.0 + w * mean;
+            double scale = w * length / k;
+            accumulate(s, -ux * factor + scale * ga_x, -uy * factor + scale * ga_y);
+            accumulate(s + 1, ux * factor + scale * gb_x, uy * factor + scale * gb_y);
+        }
+    }
+    return total;
+}
+
+std::vector<double> PathRefiner::minimize(std::vector<double> x, const Point& start, const Point& goal, const std::vector<int>& samples, double w) const {
+    const size_t dim = x.size();
+    auto dot = [dim](const std::vector<double>& u, const std::vector<double>& v) {
+        double sum = 0.0;
+        for (size_t i = 0; i < dim; ++i) {
+            sum += u[i] * v[i];
+        }
+        return sum;
+    };
+
+    std::vector<double> g, x_new(dim), g_new, direction(dim);
+    double f = evaluate(x, start, goal, samples, w, &g);
+    std::vector<std::vector<double>> s_history, y_history; // Correction pairs, oldest first
+    std::vector<double> rho_history, alpha(history);
+
+    for (int iteration = 0; iteration < max_iterations; ++iteration) {
+        // Two-loop recursion: direction = -H g, H approximating the inverse Hessian from the correction pairs
+        direction = g;
+        int m = s_history.size();
+        for (int i = m - 1; i >= 0; --i) {
+            alpha[i] = rho_history[i] * dot(s_history[i], direction);
+            for (size_t c = 0; c < dim; ++c) direction[c] -= alpha[i] * y_history[i][c];
+        }
+        double gamma = m > 0 ? dot(s_history[m - 1], y_history[m - 1]) / dot(y_history[m - 1], y_history[m - 1]) : 1.0;
+        for (size_t c = 0; c < dim; ++c) direction[c] *= gamma;
+        for (int i = 0; i < m; ++i) {
+            double beta = rho_history[i] * dot(y_history[i], direction);
+            for (size_t c = 0; c < dim; ++c) direction[c] += (alpha[i] - beta) * s_history[i][c];
+        }
+        for (size_t c = 0; c < dim; ++c) direction[c] = -direction[c];
+
+        double slope = dot(g, direction);
+        if (slope >= 0.0) { // Not a descent direction, start again from steepest descent
+            s_history.clear();
+            y_history.clear();
+            rho_history.clear();
+            direction = g;
+            for (size_t c = 0; c < dim; ++c) direction[c] = -direction[c];
+            slope = dot(g, direction);
+        }
+        if (slope == 0.0) {
+            break; // Stationary point
+        }
+
+        // Backtracking line search. Without curvature information, the first step moves by about one field spacing.
+        double step = 1.0;
+        if (s_history.empty()) {
+            double largest = 0.0;
+            for (double d : direction) largest = std::max(largest, std::abs(d));
+            step = std::min(1.0, std::min(field.cell_w, field.cell_h) / largest);
+        }
+        double f_new = 0.0;
+        int backtracks = 0;
+        for (; backtracks < MAX_BACKTRACKS; ++backtracks, step *= 0.5) {
+            for (size_t c = 0; c < dim; ++c) { // Projected into the map, which the soft penalty of the field outside it does not ensure
+                x_new[c] = std::clamp(x[c] + step * direction[c], 0.0, c % 2 == 0 ? problem.x_max : problem.y_max);
+            }
+            f_new = evaluate(x_new, start, goal, samples, w, &g_new);
+            if (f_new <= f + ARMIJO * step * slope) {
+                break;
+            }
+        }
+        if (backtracks == MAX_BACKTRACKS) {
+            break; // No decrease along the direction
+        }
+
+        std::vector<double> s(dim), y(dim);
+        for (size_t c = 0; c < dim; ++c) {
+            s[c] = x_new[c] - x[c];
+            y[c] = g_new[c] - g[c];
+        }
+        double sy = dot(s, y);
+        if (sy > 1e-12 * dot(y, y)) { // Keeps the approximation positive definite
+            if (static_cast<int>(s_history.size()) == history) {
+                s_history.erase(s_history.begin());
+                y_history.erase(y_history.begin());
+                rho_history.erase(rho_history.begin());
+            }
+            s_history.push_back(std::move(s));
+            y_history.push_back(std::move(y));
+            rho_history.push_back(1.0 / sy);
+        }
+
+        bool converged = f - f_new <= TOLERANCE * std::max(1.0, std::abs(f));
+        x.swap(x_new);
+        g.swap(g_new);
+        f = f_new;
+        if (converged) {
+            break;
+        }
+    }
+    return x;
+}
+
+bool PathRefiner::collides(const std::vector<Point>& waypoints, const Point& start, const Point& goal) const {
+    Point previous = start;
+    for (const Point& p : waypoints) {
+        if (p.x < 0.0 || p.x > problem.x_max || p.y < 0.0 || p.y > problem.y_max || problem.isCollision(previous, p)) { // Leaving the map counts as a collision
+            return true;
+        }
+        previous = p;
+    }
+    return problem.isCollision(previous, goal);
+}
+
+std::vector<Point> PathRefiner::refine(const std::vector<Point>& waypoints, const Point& start, const Point& goal) const {
+    if (waypoints.empty() || field.empty()) {
+        return waypoints;
+    }
+    std::vector<double> x;
+    std::vector<int> samples;
+    Point previous = start;
+    for (size_t k = 0; k <= waypoints.size(); ++k) {
+        const Point& p = k < waypoints.size() ? waypoints[k] : goal;
+        if (k < waypoints.size()) {
+            x.push_back(p.x);
+            x.push_back(p.y);
+        }
+        // About one sample per field spacing along the initial segment
+        double length = std::hypot(p.x - previous.x, p.y - previous.y);
+        samples.push_back(std::clamp(static_cast<int>(std::ceil(length / std::min(field.cell_w, field.cell_h))), 1, MAX_SAMPLES_PER_SEGMENT));
+        previous = p;
+    }
+
+    // The distance field only approximates the obstacles, a path crossing a corner is pushed out by a larger weight
+    auto penetration = [&](const std::vector<Point>& path) {
+        double total = 0.0;
+        Point previous = start;
+        for (const Point& p : path) {
+            total += problem.collisionDistance(previous, p);
+            previous = p;
+        }
+        return total + problem.collisionDistance(previous, goal);
+    };
+    const bool was_colliding = collides(waypoints, start, goal);
+    std::vector<Point> best = waypoints; // Colliding input: the attempt going least deep into the obstacles, the input if none does better
+    double best_penetration = was_colliding ? penetration(waypoints) : 0.0;
+    double w = weight;
+    for (int attempt = 0; attempt <= WEIGHT_INCREASES; ++attempt, w *= WEIGHT_FACTOR) {
+        std::vector<double> solution = minimize(x, start, goal, samples, w);
+        std::vector<Point> refined;
+        for (size_t k = 0; k < waypoints.size(); ++k) {
+            refined.emplace_back(solution[2 * k], solution[2 * k + 1]);
+        }
+        if (!collides(refined, start, goal)) {
+            return refined;
+        }
+        if (was_colliding) {
+            double refined_penetration = penetration(refined);
+            if (refined_penetration < best_penetration) {
+                best = std::move(refined);
+                best_penetration = refined_penetration;
+            }
+        }
+    }
+    return best;
+}
+
+std::vector<Point> PathRefiner::refinePath(const std::vector<Point>& path) const {
+    if (path.size() < 3) {
+        return path;
+    }
+    std::vector<Point> refined = refine(std::vector<Point>(path.begin() + 1, path.end() - 1), path.front(), path.back());
+    refined.insert(refined.begin(), path.front());
+    refined.push_back(path.back());
+    return refined;
+}
@@ -0,0 +1,15 @@
+#include <vector>
+#include <mutex>
+#include <utility>
+
+#include "PreparedProblem.hpp"
+
+PreparedProblem::PreparedProblem(Problem _problem, int _num_points_near_obstacles)
+    : problem(std::move(_problem)), num_points_near_obstacles(_num_points_near_obstacles),
+      vertices_obstacles(problem.verticesObstacles()), points_near_obstacles(problem.pointsNearObstacles(num_points_near_obstacles)) {
+}
+
+const DistanceField& PreparedProblem::distanceField() const {
+    std::call_once(field_built, [this]() { field.build(problem); });
+    return field;
+}
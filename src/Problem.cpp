@@ -5,30 +5,80 @@
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 
 
+// CONSTANTS
+const size_t GRID_MIN_OBSTACLES = 64; // Below this number of obstacles, no grid is built
+const char BINARY_MAGIC[8] = {'P', 'P', 'S', 'C', 'E', 'N', 'B', '1'}; // First bytes of a binary scenario file
+const uint32_t BINARY_VERSION = 2; // 2 added the grid
+const uint32_t BYTE_ORDER_MARK = 0x01020304; // Binary files are in the byte order of the machine that wrote them
+
+// Layout of a binary scenario file, every part 8-byte aligned:
+//   BinaryScenarioHeader
+//   num_obstacles Obstacle records (x, y, lx, ly)
+//   num_bounds xmin, then num_bounds xmax, num_bounds ymin and num_bounds ymax (ObstacleBounds, padding included)
+//   num_cell_bounds bounds of the grid, grouped by cell, laid out the same way
+//   grid_nx * grid_ny + 1 int32 cell starts, then zeros up to a multiple of 8 bytes (no grid section if grid_nx is 0)
+struct BinaryScenarioHeader{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t num_obstacles;
+    uint64_t num_bounds;
+    uint64_t grid_nx, grid_ny; // Cells of the ObstacleGrid, 0 when the problem has too few obstacles for one
+    uint64_t num_cell_bounds;
+    double values[11]; // x_max, y_max, start1, goal1, start2, goal2 and radius, in the order of the text format
+};
+
+static_assert(sizeof(BinaryScenarioHeader) % sizeof(double) == 0, "The obstacles must stay aligned");
+static_assert(sizeof(Obstacle) == 4 * sizeof(double) && std::is_trivially_copyable<Obstacle>::value, "Obstacles are stored as 4 packed doubles");
+static_assert(sizeof(int) == sizeof(int32_t), "Cell starts are stored as int32");
+
+static size_t cellStartBytes(size_t num_cells) { return ((num_cells + 1) * sizeof(int32_t) + 7) / 8 * 8; }
+
 // Point struct methods
 Point::Point(double _x, double _y) : x(_x), y(_y) {}
 
-bool Problem::loadScenario(const std::string& filename) {
-    // Open the file for reading
-    std::ifstream inputFile(filename);
-    if (!inputFile.is_open()) {
-        std::cerr << "Error: Could not open file " << filename << std::endl;
+static bool checkObstacle(double x, double y, double lx, double ly, double x_max, double y_max) {
+    if (lx <= 0 || ly <= 0) {
+        std::cerr << "Error  : Invalid obstacle dimensions" << std::endl;
         return false;
     }
 
-    // Read the contents of the scenario file and check for errors
-    if (!(inputFile >> x_max >> y_max >> start1.x >> start1.y 
-                    >> goal1.x >> goal1.y 
-                    >> start2.x >> start2.y 
-                    >> goal2.x >> goal2.y 
-                    >> radius)) {
-        std::cerr << "Error: Invalid file format" << std::endl;
+    if (x < 0 || x > x_max || y < 0 || y > y_max) {
+        std::cerr << "Error: Obstacle position is out of bounds" << std::endl;
         return false;
     }
 
+    if (x + lx > x_max || y + ly > y_max) {
+        std::cerr << "Error: Obstacle exceeds environment bounds" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool isBinaryScenario(const std::string& filename) {
+    std::ifstream inputFile(filename, std::ios::binary);
+    char magic[sizeof(BINARY_MAGIC)];
+    return inputFile.read(magic, sizeof(magic)) && std::memcmp(magic, BINARY_MAGIC, sizeof(magic)) == 0;
+}
+
+bool Problem::loadScenario(const std::string& filename) {
+    return isBinaryScenario(filename) ? loadBinaryScenario(filename) : loadTextScenario(filename);
+}
+
+bool Problem::checkEnvironment() const {
     // Check for valid dimensions and radius
     if (x_max <= 0 || y_max <= 0) {
         std::cerr << "Error: Invalid environment dimensions" << std::endl;
@@ -45,22 +95,35 @@ bool Problem::loadScenario(const std::string& filename) {
         std::cerr << "Error: Start or goal positions are out of bounds" << std::endl;
         return false;
     }
+    return true;
+}
 
+bool Problem::loadTextScenario(const std::string& filename) {
+    // Open the file for reading
+    std::ifstream inputFile(filename);
+    if (!inputFile.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return false;
+    }
 
-    double x, y, lx, ly;
-    while (inputFile >> x >> y >> lx >> ly) {
-        if (lx <= 0 || ly <= 0) {
-            std::cerr << "Error  : Invalid obstacle dimensions" << std::endl;
-            return false;
-        }
+    // Read the contents of the scenario file and check for errors
+    if (!(inputFile >> x_max >> y_max >> start1.x >> start1.y 
+                    >> goal1.x >> goal1.y 
+                    >> start2.x >> start2.y 
+                    >> goal2.x >> goal2.y 
+                    >> radius)) {
+        std::cerr << "Error: Invalid file format" << std::endl;
+        return false;
+    }
+
+    if (!checkEnvironment()) {
+        return false;
+    }
 
-        if (x < 0 || x > x_max || y < 0 || y > y_max) {
-            std::cerr << "Error: Obstacle position is out of bounds" << std::endl;
-            return false;
-        }
 
-        if (x + lx > x_max || y + ly > y_max) {
-            std::cerr << "Error: Obstacle exceeds environment bounds" << std::endl;
+    double x, y, lx, ly;
+    while (inputFile >> x >> y >> lx >> ly) {
+        if (!checkObstacle(x, y, lx, ly, x_max, y_max)) {
             return false;
         }
 
@@ -76,12 +139,230 @@ bool Problem::loadScenario(const std::string& filename) {
         return false;
     }
 
+    buildIndex();
     return inputFile.eof();
 }
 
+bool Problem::loadBinaryScenario(const std::string& filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(BinaryScenarioHeader))) {
+        close(fd);
+        std::cerr << "Error: Invalid file format" << std::endl;
+        return false;
+    }
+    size_t file_size = info.st_size;
+    void* data = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping stays valid
+    if (data == MAP_FAILED) {
+        std::cerr << "Error: Could not map file " << filename << std::endl;
+        return false;
+    }
+    // Unmapped when the last copy of the bounds attached to it goes away
+    std::shared_ptr<const void> mapping(data, [file_size](const void* p) { munmap(const_cast<void*>(p), file_size); });
+
+    BinaryScenarioHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    size_t n = header.num_obstacles, m = header.num_bounds, num_cell_bounds = header.num_cell_bounds;
+    size_t grid_nx = header.grid_nx, grid_ny = header.grid_ny;
+    if (header.version != BINARY_VERSION || header.byte_order != BYTE_ORDER_MARK) {
+        std::cerr << "Error: Unsupported binary scenario version or byte order" << std::endl;
+        return false;
+    }
+    // The counts are bounded by the payload before any product, so that huge counts cannot wrap the size check around
+    const size_t payload = file_size - sizeof(header);
+    const size_t max_cells = std::min<size_t>(payload / sizeof(int32_t), std::numeric_limits<int>::max());
+    if (n > payload / sizeof(Obstacle) || m > payload / (4 * sizeof(double)) || num_cell_bounds > payload / (4 * sizeof(double))
+        || grid_nx > max_cells || grid_ny > max_cells || (grid_nx == 0) != (grid_ny == 0) || (grid_ny > 0 && grid_nx > max_cells / grid_ny)
+        || m % ObstacleBounds::LANES != 0 || m < n || m >= n + ObstacleBounds::LANES || num_cell_bounds % ObstacleBounds::LANES != 0 || (grid_nx == 0 && num_cell_bounds != 0)
+        || payload != n * sizeof(Obstacle) + 4 * m * sizeof(double) + 4 * num_cell_bounds * sizeof(double) + (grid_nx ? cellStartBytes(grid_nx * grid_ny) : 0)) {
+        std::cerr << "Error: Invalid file format in obstacles" << std::endl;
+        return false;
+    }
+
+    double* values[11] = {&x_max, &y_max, &start1.x, &start1.y, &goal1.x, &goal1.y, &start2.x, &start2.y, &goal2.x, &goal2.y, &radius};
+    for (int k = 0; k < 11; ++k) {
+        *values[k] = header.values[k];
+    }
+    if (!checkEnvironment()) {
+        return false;
+    }
+
+    // The obstacle records are copied, since the planners work on std::vector<Obstacle>; the bounds and the grid used by the collision kernels are not
+    const char* records = static_cast<const char*>(data) + sizeof(header);
+    const double* xmin = reinterpret_cast<const double*>(records + n * sizeof(Obstacle));
+    const double* xmax = xmin + m;
+    const double* ymin = xmax + m;
+    const double* ymax = ymin + m;
+    obstacles.resize(n);
+    std::memcpy(obstacles.data(), records, n * sizeof(Obstacle));
+    for (size_t i = 0; i < n; ++i) {
+        const Obstacle& obs = obstacles[i];
+        if (!checkObstacle(obs.ll_corner.x, obs.ll_corner.y, obs.lx, obs.ly, x_max, y_max)) {
+            return false;
+        }
+        // Bounds that do not match the obstacles would make the kernels disagree with the reference predicates
+        if (xmin[i] != obs.ll_corner.x || xmax[i] != obs.ll_corner.x + obs.lx || ymin[i] != obs.ll_corner.y || ymax[i] != obs.ll_corner.y + obs.ly) {
+            std::cerr << "Error: Obstacle bounds do not match the obstacles" << std::endl;
+            return false;
+        }
+    }
+    for (size_t i = n; i < m; ++i) {
+        if (!(xmin[i] == xmax[i] && ymin[i] == ymax[i] && xmax[i] < 0 && ymax[i] < 0)) {
+            std::cerr << "Error: Obstacle bounds do not match the obstacles" << std::endl;
+            return false;
+        }
+    }
+
+    bounds.attach(mapping, xmin, xmax, ymin, ymax, m);
+    if (grid_nx == 0) {
+        buildGrid();
+        return true;
+    }
+
+    // The grid is attached as stored: only the cell starts are checked, so that the kernels never read past the cell bounds
+    const double* cell_xmin = ymax + m;
+    const int* cell_start = reinterpret_cast<const int*>(cell_xmin + 4 * num_cell_bounds);
+    const size_t num_cells = grid_nx * grid_ny;
+    bool valid = cell_start[0] == 0 && static_cast<size_t>(cell_start[num_cells]) == num_cell_bounds;
+    for (size_t c = 0; c < num_cells && valid; ++c) {
+        valid = cell_start[c] <= cell_start[c + 1] && (cell_start[c + 1] - cell_start[c]) % ObstacleBounds::LANES == 0;
+    }
+    if (!valid) {
+        std::cerr << "Error: Invalid file format in grid" << std::endl;
+        return false;
+    }
+    ObstacleBounds cell_bounds;
+    cell_bounds.attach(mapping, cell_xmin, cell_xmin + num_cell_bounds, cell_xmin + 2 * num_cell_bounds, cell_xmin + 3 * num_cell_bounds, num_cell_bounds);
+    grid.attach(mapping, grid_nx, grid_ny, x_max, y_max, cell_start, cell_bounds);
+    buildOccupancy();
+    return true;
+}
+
+bool Problem::saveScenario(const std::string& filename, ScenarioFormat format) const {
+    if (format == ScenarioFormat::BINARY) {
+        return saveBinaryScenario(filename);
+    }
+    std::ofstream outputFile(filename);
+    if (!outputFile.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return false;
+    }
+
+    // std::to_chars prints the shortest string that reads back to the same double, so a saved problem loads unchanged
+    char buffer[32];
+    auto write = [&](double value, const char* separator) {
+        char* end = std::to_chars(buffer, buffer + sizeof(buffer), value).ptr;
+        outputFile << "   ";
+        outputFile.write(buffer, end - buffer);
+        outputFile << separator;
+    };
+    for (double value : {x_max, y_max, start1.x, start1.y, goal1.x, goal1.y, start2.x, start2.y, goal2.x, goal2.y, radius}) {
+        write(value, "\n");
+    }
+    for (const auto& obs : obstacles) {
+        write(obs.ll_corner.x, ""); write(obs.ll_corner.y, ""); write(obs.lx, ""); write(obs.ly, "\n");
+    }
+
+    if (!outputFile) {
+        std::cerr << "Error: Could not write file " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Problem::saveBinaryScenario(const std::string& filename) const {
+    std::ofstream outputFile(filename, std::ios::binary);
+    if (!outputFile.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return false;
+    }
+
+    ObstacleBounds padded; // Written even if the bounds and grid of this problem are not built, so that loading never computes them
+    padded.assign(obstacles);
+    ObstacleGrid built_grid;
+    const ObstacleGrid* cells = &grid;
+    if (grid.empty() && obstacles.size() >= GRID_MIN_OBSTACLES) {
+        built_grid.build(obstacles, x_max, y_max);
+        cells = &built_grid;
+    }
+    const ObstacleBounds& cell_bounds = cells->cellBounds();
+    BinaryScenarioHeader header;
+    std::memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+    header.version = BINARY_VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.num_obstacles = obstacles.size();
+    header.num_bounds = padded.size();
+    header.grid_nx = cells->nx;
+    header.grid_ny = cells->ny;
+    header.num_cell_bounds = cell_bounds.size();
+    double values[11] = {x_max, y_max, start1.x, start1.y, goal1.x, goal1.y, start2.x, start2.y, goal2.x, goal2.y, radius};
+    std::memcpy(header.values, values, sizeof(values));
+
+    outputFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    outputFile.write(reinterpret_cast<const char*>(obstacles.data()), obstacles.size() * sizeof(Obstacle));
+    for (const double* bound : {padded.xmin(), padded.xmax(), padded.ymin(), padded.ymax()}) {
+        outputFile.write(reinterpret_cast<const char*>(bound), padded.size() * sizeof(double));
+    }
+    if (!cells->empty()) {
+        for (const double* bound : {cell_bounds.xmin(), cell_bounds.xmax(), cell_bounds.ymin(), cell_bounds.ymax()}) {
+            outputFile.write(reinterpret_cast<const char*>(bound), cell_bounds.size() * sizeof(double));
+        }
+        const size_t num_cells = static_cast<size_t>(cells->nx) * cells->ny;
+        std::vector<char> starts(cellStartBytes(num_cells), 0);
+        std::memcpy(starts.data(), cells->cellStart(), (num_cells + 1) * sizeof(int32_t));
+        outputFile.write(starts.data(), starts.size());
+    }
+
+    if (!outputFile) {
+        std::cerr << "Error: Could not write file " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void Problem::buildIndex() {
+    bounds.assign(obstacles);
+    buildGrid();
+}
+
+void Problem::buildGrid() {
+    if (obstacles.size() >= GRID_MIN_OBSTACLES) {
+        grid.build(obstacles, x_max, y_max);
+    } else {
+        grid.clear(); // A vectorized sweep over a few obstacles is cheaper than walking the grid
+    }
+    buildOccupancy();
+}
+
+void Problem::buildOccupancy() {
+    if (obstacles.size() >= GRID_MIN_OBSTACLES && occupancy_cell_size >= 0.0) {
+        occupancy.build(obstacles, x_max, y_max, occupancy_cell_size);
+    } else {
+        occupancy.clear();
+    }
+}
+
+bool Problem::isOccupied(const Point& p) const {
+    if (!occupancy.empty()) {
+        return occupancy.contains(p, obstacles);
+    }
+    return pointInObstacles(p, obstacles); // No bitmap built, test every obstacle
+}
+
 bool Problem::isCollision(const Point& p1, const Point& p2) const {
     // Check if the line segment between p1 and p2 collides with any obstacles
-    return segmentIntersectsObstacles(p1, p2, obstacles);
+    if (!grid.empty()) {
+        return grid.segmentIntersects(p1, p2);
+    }
+    if (!bounds.empty()) {
+        return segmentHitsBounds(bounds, 0, bounds.size(), p1, p2);
+    }
+    return segmentIntersectsObstacles(p1, p2, obstacles); // No index built, test every obstacle
 };
 
 bool Problem::isCollision(const std::vector<Point>& path) const {
@@ -105,6 +386,17 @@ bool Problem::isCollision(const std::vector<Point>& path) const {
 };
 
 
+double Problem::collisionDistance(const Point& p1, const Point& p2) const {
+    // Calculate the distance travelled into obstacles by the line segment between p1 and p2
+    if (!grid.empty()) {
+        return grid.segmentCollisionDistance(p1, p2);
+    }
+    if (!bounds.empty()) {
+        return segmentPenetrationBounds(bounds, 0, bounds.size(), p1, p2);
+    }
+    return segmentCollisionDistance(p1, p2, obstacles); // No index built, sum over every obstacle
+};
+
 double Problem::collisionDistance(const std::vector<Point>& path) const {
     double total_collision_distance = 0.0;
     if (path.size() < 2) {
@@ -113,11 +405,11 @@ double Problem::collisionDistance(const std::vector<Point>& path) const {
 
     // Check each segment of the inner path for collision distance
     for (size_t i = 0; i < path.size() - 1; ++i) {
-        total_collision_distance += segmentCollisionDistance(path[i], path[i + 1], obstacles);
+        total_collision_distance += collisionDistance(path[i], path[i + 1]);
     }
     // Check the segments from start to first waypoint and last waypoint to goal
-    total_collision_distance += segmentCollisionDistance(start1, path.front(), obstacles);
-    total_collision_distance += segmentCollisionDistance(path.back(), goal1, obstacles);
+    total_collision_distance += collisionDistance(start1, path.front());
+    total_collision_distance += collisionDistance(path.back(), goal1);
 
     return total_collision_distance;
 };
@@ -166,7 +458,7 @@ std::vector<Point> Problem::pointsNearObstacles(double N) const {
             } else {
                 p = Point(obs.ll_corner.x - 1e-4*x_max, obs.ll_corner.y + (1 - (t - 0.75) * 4) * obs.ly); // Left edge
             }
-            if(!pointOnBoundary(p, x_max, y_max) && !pointInObstacles(p, obstacles)) { // Ensure the point is not on the boundary and not inside any obstacle
+            if(!pointOnBoundary(p, x_max, y_max) && !isOccupied(p)) { // Ensure the point is not on the boundary and not inside any obstacle
                 points.push_back(p);
             }
         }
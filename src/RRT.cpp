@@ -4,31 +4,114 @@
 #include <functional>
 #include <algorithm>
 #include <tuple>
+#include <atomic>
+#include <thread>
+#include <chrono>
 
 #include "RRT.hpp"
 #include "Problem.hpp"
+#include "Sampler.hpp"
 #include "utils.hpp"
 
+// CONSTANTS
+const int MAX_ELLIPSE_ATTEMPTS = 100; // Informed samples drawn before falling back to the whole map, when the ellipse sticks out of it
+
 Tree::Tree(Point root) {
     // Initialize the tree with the given root point
     vertices.push_back(root);
     parents.push_back(-1); // Root has no parent
     costs.push_back(0.0); // Cost from root to itself is 0
+    first_child.push_back(-1);
+    next_sibling.push_back(-1);
+    prev_sibling.push_back(-1);
+    index.insert(root, 0);
+}
+
+void Tree::link(int i, int parent) {
+    // Insert i at the head of the children of parent
+    prev_sibling[i] = -1;
+    next_sibling[i] = first_child[parent];
+    if (first_child[parent] != -1) {
+        prev_sibling[first_child[parent]] = i;
+    }
+    first_child[parent] = i;
+}
+
+void Tree::unlink(int i) {
+    // Remove i from the children of its parent
+    if (prev_sibling[i] != -1) {
+        next_sibling[prev_sibling[i]] = next_sibling[i];
+    } else {
+        first_child[parents[i]] = next_sibling[i];
+    }
+    if (next_sibling[i] != -1) {
+        prev_sibling[next_sibling[i]] = prev_sibling[i];
+    }
 }
 
-RRT::RRT(const Problem& problem) : tree(problem.start1), tree2(problem.start2) {
+int Tree::add(const Point& vertex, int parent) {
+    int i = vertices.size();
+    vertices.push_back(vertex);
+    parents.push_back(parent);
+    costs.push_back(costs[parent] + euclideanDistance(vertices[parent], vertex));
+    first_child.push_back(-1);
+    next_sibling.push_back(-1);
+    prev_sibling.push_back(-1);
+    link(i, parent);
+    index.insert(vertex, i);
+    return i;
+}
+
+int Tree::updateSubtreeCosts(int i) {
+    int size = 0;
+    subtree_stack.assign(1, i);
+    while (!subtree_stack.empty()) {
+        int k = subtree_stack.back();
+        subtree_stack.pop_back();
+        ++size;
+        for (int c = first_child[k]; c != -1; c = next_sibling[c]) {
+            costs[c] = costs[k] + euclideanDistance(vertices[k], vertices[c]);
+            subtree_stack.push_back(c);
+        }
+    }
+    return size;
+}
+
+int Tree::reparent(int i, int parent) {
+    unlink(i);
+    parents[i] = parent;
+    link(i, parent);
+    costs[i] = costs[parent] + euclideanDistance(vertices[parent], vertices[i]);
+    return updateSubtreeCosts(i);
+}
+
+void Tree::rebuildChildren() {
+    size_t n = vertices.size();
+    first_child.assign(n, -1);
+    next_sibling.assign(n, -1);
+    prev_sibling.assign(n, -1);
+    for (size_t i = n; i-- > 0;) { // Backwards, so that the children are listed by increasing index
+        if (parents[i] != -1) {
+            link(i, parents[i]);
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (parents[i] == -1) {
+            costs[i] = 0.0;
+            updateSubtreeCosts(i);
+        }
+    }
+}
+
+RRT::RRT(const Problem& problem, uint64_t seed) : tree(problem.start1), tree2(problem.start2), rng(seed, streamId(StreamDomain::RRT, 0)) {
     // The constructor initializes the tree with the start point
 }
 
 void RRT::addVertex(const Point& vertex, int parent_index, bool is_second_robot) {
     if(is_second_robot) {
-        tree2.vertices.push_back(vertex);
-        tree2.parents.push_back(parent_index);
-        tree2.costs.push_back(tree2.costs[parent_index] + euclideanDistance(tree2.vertices[parent_index], vertex));
+        tree2.add(vertex, parent_index);
     } else {
-        tree.vertices.push_back(vertex);
-        tree.parents.push_back(parent_index);
-        tree.costs.push_back(tree.costs[parent_index] + euclideanDistance(tree.vertices[parent_index], vertex));
+        tree.add(vertex, parent_index);
     }
 }
 
@@ -54,117 +137,188 @@ std::vector<Point> RRT::reconstructPath(int vertex_index, bool is_second_robot)
 
 Point RRT::randomSample_naive(const Problem& problem) const {
     // Sample a random point uniformly in the environment
-    double x = static_cast<double>(rand()) / RAND_MAX * problem.x_max;
-    double y = static_cast<double>(rand()) / RAND_MAX * problem.y_max;
+    double x = rng.uniform() * problem.x_max;
+    double y = rng.uniform() * problem.y_max;
     return Point(x, y);
 }
 
-Point RRT::randomSample_intelligent(const Problem& problem, std::vector<Point> verticesObstacles, double p_vertex_obstacle, std::vector<Point> pointsNearObstacles, double p_edge_obstacle) const {
+Point RRT::randomSample_intelligent(const Problem& problem, const std::vector<Point>& verticesObstacles, double p_vertex_obstacle, const std::vector<Point>& pointsNearObstacles, double p_edge_obstacle) const {
     // Sample a random point with intelligent method proposed in question 21
-    double r = static_cast<double>(rand()) / RAND_MAX; // random in [0, 1]
+    double r = rng.uniform(); // random in [0, 1)
     if (r < p_vertex_obstacle && !verticesObstacles.empty()) {
-        return verticesObstacles[rand() % verticesObstacles.size()]; // Sample from obstacle vertices
+        return verticesObstacles[rng.uniformIndex(verticesObstacles.size())]; // Sample from obstacle vertices
     } else if (r < p_vertex_obstacle + p_edge_obstacle && !pointsNearObstacles.empty()) {
-        return pointsNearObstacles[rand() % pointsNearObstacles.size()]; // Sample from points near obstacles
+        return pointsNearObstacles[rng.uniformIndex(pointsNearObstacles.size())]; // Sample from points near obstacles
     } else {
         return randomSample_naive(problem); // Sample uniformly from the environment
     }
 }
 
-bool RRT::edgeCollisionPath(const Problem& problem, const Point& p1, const double cost1, const Point& p2, const std::vector<Point>& path) const {
-    // Check if the edge between p1 and p2 intersects with any segment of the path
-    double cost_path = 0.0;
-    for (size_t i = 0; i < path.size() - 1; ++i) {
-        if (segmentsIntersect(p1, p2, path[i], path[i + 1])) {
-            Point intersection_point;
-            getIntersectionPoint(p1, p2, path[i], path[i + 1], intersection_point);
-            if (std::abs(euclideanDistance(p1, intersection_point) + cost1 - (euclideanDistance(path[i],intersection_point) + cost_path)) < 2*problem.radius) {
-                return true; // Collision detected
-            }
-        }
-        cost_path += euclideanDistance(path[i], path[i+1]);
+Sampler RRT::makeSampler(const Problem& problem, bool is_second_robot, bool use_intelligent_sampling, double p_vertex_obstacle, double p_edge_obstacle, int num_points_near_obstacles, std::vector<Point>& verticesObstacles, std::vector<Point>& pointsNearObstacles) const {
+    const std::vector<Point>* vertices = &verticesObstacles;
+    const std::vector<Point>* points = &pointsNearObstacles;
+    if (prepared) {
+        vertices = &prepared->verticesObstacles();
+        points = &prepared->pointsNearObstacles();
+    } else if (use_intelligent_sampling) {
+        verticesObstacles = problem.verticesObstacles();
+        pointsNearObstacles = problem.pointsNearObstacles(num_points_near_obstacles);
     }
-    return false; // No collision
+    Sampler sampler(problem, is_second_robot ? problem.goal2 : problem.goal1, *vertices, *points);
+    double p_uniform = 1.0 - p_goal - (use_intelligent_sampling ? p_vertex_obstacle + p_edge_obstacle : 0.0);
+    sampler.setWeights({
+        {quasi_random ? SamplingStrategy::HALTON : SamplingStrategy::UNIFORM, std::max(0.0, p_uniform)},
+        {SamplingStrategy::OBSTACLE_VERTICES, use_intelligent_sampling ? p_vertex_obstacle : 0.0},
+        {SamplingStrategy::OBSTACLE_EDGES, use_intelligent_sampling ? p_edge_obstacle : 0.0},
+        {SamplingStrategy::GOAL, p_goal}
+    });
+    return sampler;
 }
 
-int RRT::buildRRT(const Problem& problem, double delta_s, double delta_r, int max_iterations, bool use_intelligent_sampling, double p_vertex_obstacle, double p_edge_obstacle, int num_points_near_obstacles, bool is_second_robot, std::vector<Point> path_first_robot) {
-    // Implementation of the RRT algorithm to build the tree
+bool RRT::edgeCollisionPath(const Problem& problem, const Point& p1, const double cost1, const Point& p2, const PathIndex& path) const {
+    // Check if the edge between p1 and p2 intersects with a segment of the path where both robots are within 2 radii of time
+    return path.conflicts(p1, cost1, p2, 2 * problem.radius);
+}
+
+int RRT::extendRRTStar(const Problem& problem, const Point& vr, double delta_s, double delta_r, bool is_second_robot, const PathIndex& path_first_robot, std::vector<int>& neighbors, bool* rewired) {
     Tree& tree_cur = is_second_robot ? tree2 : tree; // Considered tree (tree or tree2 depending on the robot)
-    std::vector<Point> verticesObstacles;
-    std::vector<Point> pointsNearObstacles;
-    if(use_intelligent_sampling) {
-        verticesObstacles = problem.verticesObstacles();
-        pointsNearObstacles = problem.pointsNearObstacles(num_points_near_obstacles); 
+
+    // Find the nearest vertex in the tree
+    int vn_index = tree_cur.index.nearest(vr);
+
+    // Create node v in the direction of vr at maximum distance delta_s from vn
+    Point vn = tree_cur.vertices[vn_index];
+    Point v;
+    double dist = euclideanDistance(vn, vr);
+    if (dist <= delta_s) {
+        v = vr;
+    } else {
+        double theta = atan2(vr.y - vn.y, vr.x - vn.x);
+        v = Point(vn.x + delta_s * cos(theta), vn.y + delta_s * sin(theta));
     }
-    
-    int iterations = 0;
-    while(iterations < max_iterations){
-        
-        Point vr;
-        if(use_intelligent_sampling) {
-            vr = randomSample_intelligent(problem, verticesObstacles, p_vertex_obstacle, pointsNearObstacles, p_edge_obstacle);
-        } else {
-            vr = randomSample_naive(problem);
+    // Validity of the edge from vertex i to v, against the obstacles and, for the second robot, the path of the first.
+    // Every edge of this call ends at v, so the answers are cached by i, and reset before returning.
+    if (edge_state.size() < tree_cur.vertices.size() + 1) {
+        edge_state.resize(2 * tree_cur.vertices.size() + 1, EDGE_UNKNOWN);
+    }
+    auto edgeValid = [&](int i) {
+        ++edge_cache_stats.queries;
+        if (edge_state[i] != EDGE_UNKNOWN) {
+            ++edge_cache_stats.hits;
+            return edge_state[i] == EDGE_FREE;
         }
-
-        if(pointInObstacles(vr, problem.obstacles)){
-            continue; // Skip if the random point is inside an obstacle
+        edge_touched.push_back(i);
+        BadEdge key{i, v.x, v.y};
+        if (cache_bad_edges && bad_edges[is_second_robot].count(key)) {
+            ++edge_cache_stats.bad_edge_hits;
+            edge_state[i] = EDGE_BLOCKED;
+            return false;
         }
-        // Find the nearest vertex in the tree
-        int vn_index = 0;
-        for (size_t i = 1; i < tree_cur.vertices.size(); i++) {
-            if (euclideanDistance(tree_cur.vertices[i], vr) < euclideanDistance(tree_cur.vertices[vn_index], vr)) {
-                vn_index = i;
-            }
+        bool valid = !problem.isCollision(tree_cur.vertices[i], v)
+            && !(is_second_robot && edgeCollisionPath(problem, tree_cur.vertices[i], tree_cur.costs[i], v, path_first_robot));
+        edge_state[i] = valid ? EDGE_FREE : EDGE_BLOCKED;
+        if (!valid && cache_bad_edges) {
+            bad_edges[is_second_robot].insert(key);
         }
+        return valid;
+    };
+    auto resetEdgeStates = [&]() {
+        for (int i : edge_touched) {
+            edge_state[i] = EDGE_UNKNOWN;
+        }
+        edge_touched.clear();
+    };
 
-        // Create node v in the direction of vr at maximum distance delta_s from vn
-        Point vn = tree_cur.vertices[vn_index];
-        Point v;
-        double dist = euclideanDistance(vn, vr);
-        if (dist <= delta_s) {
-            v = vr;
-        } else {
-            double theta = atan2(vr.y - vn.y, vr.x - vn.x);
-            v = Point(vn.x + delta_s * cos(theta), vn.y + delta_s * sin(theta));
+    // Choose the parent of v
+    int parent_index = -1;
+    tree_cur.index.radius(v, delta_r, neighbors); // Vertices within delta_r of v
+    if (lazy_collision) {
+        // Candidates by increasing cost through them, checked in that order until one is collision-free: an edge is
+        // only checked once it is the best remaining one. The stable sort keeps the tie-breaking of the eager loop below.
+        parent_candidates.clear();
+        parent_candidates.emplace_back(tree_cur.costs[vn_index] + euclideanDistance(vn, v), vn_index);
+        for (int i : neighbors) {
+            if (i != vn_index) {
+                parent_candidates.emplace_back(tree_cur.costs[i] + euclideanDistance(tree_cur.vertices[i], v), i);
+            }
         }
-        // Choose the parent of v
-        int parent_index = -1;
-        if (!problem.isCollision(vn, v) && !(is_second_robot && edgeCollisionPath(problem, vn, tree_cur.costs[vn_index], vr, path_first_robot))) {
+        std::stable_sort(parent_candidates.begin(), parent_candidates.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        for (const auto& [cost, i] : parent_candidates) {
+            if (edgeValid(i)) {
+                parent_index = i;
+                break;
+            }
+        }
+    } else {
+        if (edgeValid(vn_index)) {
             parent_index = vn_index;
         }
-        for (size_t i = 0; i < tree_cur.vertices.size(); i++) {
-            if (euclideanDistance(tree_cur.vertices[i], v) < delta_r 
-                && !problem.isCollision(tree_cur.vertices[i], v)
-                && !(is_second_robot && edgeCollisionPath(problem, tree_cur.vertices[i], tree_cur.costs[i], v, path_first_robot))
+        for (int i : neighbors) {
+            if (edgeValid(i)
                 && (parent_index == -1 
                     || tree_cur.costs[i] + euclideanDistance(tree_cur.vertices[i], v) < tree_cur.costs[parent_index] + euclideanDistance(tree_cur.vertices[parent_index], v))) {
                 parent_index = i;
             }
         }
-        if (parent_index == -1) {
-            continue; // No valid parent found, skip this vertex
-        }
+    }
+    if (parent_index == -1) {
+        resetEdgeStates();
+        return -1; // No valid parent found
+    }
 
-        addVertex(v, parent_index);
-        int index_v = tree_cur.vertices.size() - 1;
-    
-        // Update neighors' parent if it improves their cost
-        if(!is_second_robot){
-            for (size_t i = 0; i < tree_cur.vertices.size(); i++) {
-                if (euclideanDistance(tree_cur.vertices[i], v) < delta_r 
-                    && !problem.isCollision(tree_cur.vertices[i], v)
-                    && tree_cur.costs[i] > tree_cur.costs[index_v] + euclideanDistance(tree_cur.vertices[index_v], tree_cur.vertices[i])) {
-                    tree_cur.parents[i] = index_v; // Update parent to the new vertex
-                    tree_cur.costs[i] = tree_cur.costs[index_v] + euclideanDistance(tree_cur.vertices[index_v], tree_cur.vertices[i]);
+    addVertex(v, parent_index, is_second_robot);
+    int index_v = tree_cur.vertices.size() - 1;
+
+    // Update neighors' parent if it improves their cost
+    if(!is_second_robot){
+        for (int i : neighbors) { // v itself is not among the neighbors computed before its insertion, and could not improve its own cost anyway
+            if (tree_cur.costs[i] > tree_cur.costs[index_v] + euclideanDistance(tree_cur.vertices[index_v], tree_cur.vertices[i])
+                && edgeValid(i)) { // Only the edges that would win the rewire are checked, most of them already were by the choice of the parent
+                tree_cur.reparent(i, index_v); // Update parent to the new vertex, and the costs of the descendants of i
+                if (rewired) {
+                    *rewired = true;
                 }
             }
         }
+    }
+    resetEdgeStates();
+    return index_v;
+}
+
+int RRT::buildRRT(const Problem& problem, double delta_s, double delta_r, int max_iterations, bool use_intelligent_sampling, double p_vertex_obstacle, double p_edge_obstacle, int num_points_near_obstacles, bool is_second_robot, std::vector<Point> path_first_robot) {
+    // Implementation of the RRT algorithm to build the tree
+    PathIndex first_robot; // Space-time index of the path to avoid, indexed once for all the edge checks
+    if (is_second_robot) {
+        first_robot.build(path_first_robot);
+        bad_edges[1].clear(); // Blocked edges of tree2 may have been blocked by the previous path of the first robot only
+    }
+    if (num_threads > 1) {
+        return buildRRTParallel(problem, delta_s, delta_r, max_iterations, use_intelligent_sampling, p_vertex_obstacle, p_edge_obstacle, num_points_near_obstacles, is_second_robot, first_robot);
+    }
+    std::vector<Point> verticesObstacles, pointsNearObstacles; // Only filled when there is no prepared problem
+    
+    Sampler sampler = makeSampler(problem, is_second_robot, use_intelligent_sampling, p_vertex_obstacle, p_edge_obstacle, num_points_near_obstacles, verticesObstacles, pointsNearObstacles);
+    
+    std::vector<int> neighbors; // Reused buffer for radius queries
+    int iterations = 0;
+    while(iterations < max_iterations){
+        
+        Point vr = sampler.next(rng);
+
+        if(problem.isOccupied(vr)){
+            continue; // Skip if the random point is inside an obstacle
+        }
+        int index_v = extendRRTStar(problem, vr, delta_s, delta_r, is_second_robot, first_robot, neighbors);
+        if (index_v == -1) {
+            continue; // No valid parent found, skip this vertex
+        }
 
         // Check if we can connect to the goal
+        const Tree& tree_cur = is_second_robot ? tree2 : tree;
+        Point v = tree_cur.vertices[index_v];
         Point goal = is_second_robot ? problem.goal2 : problem.goal1;
         if (euclideanDistance(v, goal) <= delta_s && !problem.isCollision(v, goal)) {
-            addVertex(goal, index_v);
+            addVertex(goal, index_v, is_second_robot);
             break; // Goal reached, exit the loop
         }
 
@@ -174,8 +328,337 @@ int RRT::buildRRT(const Problem& problem, double delta_s, double delta_r, int ma
     return iterations;
 }
 
+/*
+Anytime Informed RRT* (Gammell et al.): the RRT* of buildRRT, which keeps growing once the goal is reached, until
+max_iterations vertices were added or time_budget ran out. Every vertex within delta_s of the goal that sees it is
+a candidate last vertex, and the best candidate gives the current solution, passed to on_solution whenever it
+improves. Once there is a solution of cost c, only the states that could improve it are sampled: those of the
+ellipse with foci the start and the goal whose points have a total distance to the foci below c.
+A rewiring can shorten the path of any candidate, so they are all compared again after one.
+*/
+int RRT::buildInformed(const Problem& problem, double delta_s, double delta_r, int max_iterations, bool use_intelligent_sampling, double p_vertex_obstacle, double p_edge_obstacle, int num_points_near_obstacles, bool is_second_robot, const PathIndex& path_first_robot) {
+    Tree& tree_cur = is_second_robot ? tree2 : tree;
+    const Point start = tree_cur.vertices[0];
+    const Point goal = is_second_robot ? problem.goal2 : problem.goal1;
+    std::vector<Point> verticesObstacles, pointsNearObstacles; // Only filled when there is no prepared problem
+    Sampler sampler = makeSampler(problem, is_second_robot, use_intelligent_sampling, p_vertex_obstacle, p_edge_obstacle, num_points_near_obstacles, verticesObstacles, pointsNearObstacles);
+    const auto start_time = std::chrono::steady_clock::now();
+    auto timeUp = [&]() {
+        return time_budget > 0.0 && std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count() >= time_budget;
+    };
+    auto pathCost = [&](int index) { // Length of the path from the root to the goal through the vertex index
+        return tree_cur.costs[index] + euclideanDistance(tree_cur.vertices[index], goal);
+    };
+
+    // Ellipse of the informed samples, for the current best cost
+    const double c_min = euclideanDistance(start, goal);
+    const double theta = atan2(goal.y - start.y, goal.x - start.x);
+    const Point center((start.x + goal.x) / 2, (start.y + goal.y) / 2);
+    auto sampleInformed = [&](double c_best) {
+        double a = c_best / 2, b = sqrt(std::max(0.0, c_best * c_best - c_min * c_min)) / 2;
+        if (M_PI * a * b < problem.x_max * problem.y_max) {
+            for (int attempt = 0; attempt < MAX_ELLIPSE_ATTEMPTS; ++attempt) {
+                double r = sqrt(rng.uniform()), phi = 2 * M_PI * rng.uniform(); // Uniform in the unit disk
+                double x = a * r * cos(phi), y = b * r * sin(phi);
+                Point p(center.x + x * cos(theta) - y * sin(theta), center.y + x * sin(theta) + y * cos(theta));
+                if (p.x >= 0 && p.x <= problem.x_max && p.y >= 0 && p.y <= problem.y_max) {
+                    return p;
+                }
+            }
+        }
+        return randomSample_naive(problem); // The ellipse covers most of the map
+    };
+
+    std::vector<int> neighbors;
+    std::vector<int> candidates; // Vertices connected to the goal
+    int best_parent = -1;
+    double best_cost = INFINITY;
+    int iterations = 0;
+    while (iterations < max_iterations && !timeUp()) {
+        Point vr = best_parent != -1 ? sampleInformed(best_cost) : sampler.next(rng);
+        if (problem.isOccupied(vr)) {
+            continue;
+        }
+        bool rewired = false;
+        int index_v = extendRRTStar(problem, vr, delta_s, delta_r, is_second_robot, path_first_robot, neighbors, &rewired);
+        if (index_v == -1) {
+            continue;
+        }
+        iterations++;
+
+        bool candidate = euclideanDistance(tree_cur.vertices[index_v], goal) <= delta_s && !problem.isCollision(tree_cur.vertices[index_v], goal);
+        if (candidate) {
+            candidates.push_back(index_v);
+        }
+        if (!candidate && !rewired) {
+            continue; // No path to the goal changed
+        }
+        double previous_cost = best_cost;
+        if (rewired) {
+            for (int k : candidates) { // The rewiring may have shortened the path of any of them
+                double cost = pathCost(k);
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best_parent = k;
+                }
+            }
+        } else if (pathCost(index_v) < best_cost) {
+            best_cost = pathCost(index_v);
+            best_parent = index_v;
+        }
+        if (on_solution && best_cost < previous_cost) {
+            std::vector<Point> path = reconstructPath(best_parent, is_second_robot);
+            path.push_back(tree_cur.vertices[best_parent]); // reconstructPath leaves out its last vertex, which is not the goal here
+            on_solution(path, best_cost, iterations);
+        }
+    }
+
+    if (best_parent != -1) {
+        addVertex(goal, best_parent, is_second_robot);
+    }
+    return iterations;
+}
+
+/*
+RRT-Connect (Kuffner and LaValle): at every iteration one tree takes a step of at most delta_s towards a random
+sample, then the other tree extends towards the new vertex in steps of delta_s until it reaches it or is blocked,
+and the two trees swap roles. There is no rewiring, the first path found is kept as it is.
+For the second robot, the edges of the start tree are checked against the first robot's path as in buildRRT. The
+arrival times along the goal tree are only known once the trees meet, so its branch is checked then.
+*/
+int RRT::buildConnect(const Problem& problem, double delta_s, int max_iterations, bool use_intelligent_sampling, double p_vertex_obstacle, double p_edge_obstacle, int num_points_near_obstacles, bool is_second_robot, const PathIndex& path_first_robot) {
+    Tree& start_tree = is_second_robot ? tree2 : tree;
+    const Point goal = is_second_robot ? problem.goal2 : problem.goal1;
+    Tree goal_tree(goal);
+    std::vector<Point> verticesObstacles, pointsNearObstacles; // Only filled when there is no prepared problem
+    Sampler sampler = makeSampler(problem, is_second_robot, use_intelligent_sampling, p_vertex_obstacle, p_edge_obstacle, num_points_near_obstacles, verticesObstacles, pointsNearObstacles);
+
+    // Step of at most delta_s from the nearest vertex of t towards target, returns the index of the vertex reached or -1 if blocked
+    auto extend = [&](Tree& t, const Point& target) {
+        int vn_index = t.index.nearest(target);
+        Point vn = t.vertices[vn_index];
+        double dist = euclideanDistance(vn, target);
+        if (dist == 0.0) {
+            return vn_index; // Already in the tree
+        }
+        Point v = target;
+        if (dist > delta_s) {
+            double theta = atan2(target.y - vn.y, target.x - vn.x);
+            v = Point(vn.x + delta_s * cos(theta), vn.y + delta_s * sin(theta));
+        }
+        if (problem.isCollision(vn, v)
+            || (is_second_robot && &t == &start_tree && edgeCollisionPath(problem, vn, t.costs[vn_index], v, path_first_robot))) {
+            return -1;
+        }
+        return t.add(v, vn_index);
+    };
+    // Extends t towards target until it reaches it, returns the index of target in t or -1 if blocked
+    auto connect = [&](Tree& t, const Point& target) {
+        int index = extend(t, target);
+        while (index != -1 && (t.vertices[index].x != target.x || t.vertices[index].y != target.y)) {
+            index = extend(t, target);
+        }
+        return index;
+    };
+    // Whether the branch of the goal tree from goal_index avoids the first robot, when continuing the start tree at start_index
+    auto branchAvoidsFirstRobot = [&](int start_index, int goal_index) {
+        double cost = start_tree.costs[start_index];
+        for (int k = goal_index; goal_tree.parents[k] != -1; k = goal_tree.parents[k]) {
+            const Point& p = goal_tree.vertices[k];
+            const Point& next = goal_tree.vertices[goal_tree.parents[k]];
+            if (edgeCollisionPath(problem, p, cost, next, path_first_robot)) {
+                return false;
+            }
+            cost += euclideanDistance(p, next);
+        }
+        return true;
+    };
+
+    Tree* a = &start_tree; // Tree extended towards the sample
+    Tree* b = &goal_tree; // Tree connected to the new vertex
+    int iterations = 0;
+    while (iterations < max_iterations) {
+        Point vr = sampler.next(rng);
+        if (problem.isOccupied(vr)) {
+            continue; // Skip if the random point is inside an obstacle
+        }
+        int new_index = extend(*a, vr);
+        if (new_index != -1) {
+            iterations++; // Counted as in buildRRT, once the sample gave a vertex
+            int reached = connect(*b, a->vertices[new_index]);
+            if (reached != -1) {
+                int start_index = a == &start_tree ? new_index : reached;
+                int goal_index = a == &start_tree ? reached : new_index;
+                if (!is_second_robot || branchAvoidsFirstRobot(start_index, goal_index)) {
+                    // Graft the branch of the goal tree, the meeting vertex excluded since both trees hold it
+                    int parent = start_index;
+                    for (int k = goal_tree.parents[goal_index]; k != -1; k = goal_tree.parents[k]) {
+                        addVertex(goal_tree.vertices[k], parent, is_second_robot);
+                        parent = start_tree.vertices.size() - 1;
+                    }
+                    break;
+                }
+            }
+        }
+        std::swap(a, b);
+    }
+    return iterations;
+}
+
+/*
+Parallel RRT*: every thread runs the loop of buildRRT (sample, nearest, choose parent, insert, rewire) on its own
+random stream, against the same tree.
+- Appending is lock-free: the arrays are sized for max_iterations new vertices beforehand, a thread takes the next
+  slot with an atomic increment once it has found a parent, fills it, then publishes the vertex by linking it into
+  the k-d tree (KDTree::insertConcurrent). Other threads only find vertices through the k-d tree, so they never
+  see a slot being filled.
+- Parents and costs live in atomic shadow arrays during the growth. The collision checks of a rewire run without
+  any lock, and only the final compare-and-update of the neighbor holds that neighbor's spin lock.
+- Costs only decrease, and a rewire sets a cost to (current cost of the new parent + edge), so a child always costs
+  more than its parent and the rewires cannot create cycles. The descendants of a rewired vertex keep their costs
+  until the threads are done, since updating them would lock whole subtrees, then all the costs are recomputed.
+The goal is added once the threads are done, so that it is the last vertex as in the sequential version. Runs are
+not reproducible, since the order of the insertions depends on the scheduling.
+*/
+int RRT::buildRRTParallel(const Problem& problem, double delta_s, double delta_r, int max_iterations, bool use_intelligent_sampling, double p_vertex_obstacle, double p_edge_obstacle, int num_points_near_obstacles, bool is_second_robot, const PathIndex& path_first_robot) {
+    Tree& tree_cur = is_second_robot ? tree2 : tree;
+    std::vector<Point> verticesObstacles, pointsNearObstacles; // Only filled when there is no prepared problem
+    const Point goal = is_second_robot ? problem.goal2 : problem.goal1;
+    const Sampler sampler = makeSampler(problem, is_second_robot, use_intelligent_sampling, p_vertex_obstacle, p_edge_obstacle, num_points_near_obstacles, verticesObstacles, pointsNearObstacles);
+
+    const int first_slot = tree_cur.vertices.size();
+    const int capacity = first_slot + std::max(0, max_iterations);
+    tree_cur.vertices.resize(capacity);
+    tree_cur.index.reserveConcurrent(capacity);
+    std::vector<std::atomic<int>> parents(capacity);
+    std::vector<std::atomic<double>> costs(capacity);
+    std::vector<std::atomic<bool>> locks(capacity);
+    for (int i = 0; i < first_slot; ++i) {
+        parents[i].store(tree_cur.parents[i], std::memory_order_relaxed);
+        costs[i].store(tree_cur.costs[i], std::memory_order_relaxed);
+        locks[i].store(false, std::memory_order_relaxed);
+    }
+    std::atomic<int> next_slot{first_slot};
+    std::atomic<int> goal_parent{-1};
+
+    uint64_t seed = rng.nextU64(); // The thread streams are derived from rng, so the sequential stream moves on too
+    auto grow = [&](int thread) {
+        RandomStream stream(seed, streamId(StreamDomain::RRT, thread + 1));
+        Sampler local_sampler = sampler; // Own batch and Halton position
+        std::vector<int> neighbors;
+        auto edgeValid = [&](int i, const Point& v) {
+            return !problem.isCollision(tree_cur.vertices[i], v)
+                && !(is_second_robot && edgeCollisionPath(problem, tree_cur.vertices[i], costs[i].load(std::memory_order_relaxed), v, path_first_robot));
+        };
+        while (goal_parent.load(std::memory_order_relaxed) == -1 && next_slot.load(std::memory_order_relaxed) < capacity) {
+            Point vr = local_sampler.next(stream);
+            if (problem.isOccupied(vr)) {
+                continue;
+            }
+            int vn_index = tree_cur.index.nearest(vr);
+            Point vn = tree_cur.vertices[vn_index];
+            Point v;
+            double dist = euclideanDistance(vn, vr);
+            if (dist <= delta_s) {
+                v = vr;
+            } else {
+                double theta = atan2(vr.y - vn.y, vr.x - vn.x);
+                v = Point(vn.x + delta_s * cos(theta), vn.y + delta_s * sin(theta));
+            }
+
+            // Choose the parent, as in buildRRT, on the costs at the time they are read
+            int parent_index = edgeValid(vn_index, v) ? vn_index : -1;
+            double parent_cost = parent_index == -1 ? 0.0 : costs[vn_index].load(std::memory_order_relaxed) + euclideanDistance(vn, v);
+            tree_cur.index.radius(v, delta_r, neighbors);
+            for (int i : neighbors) {
+                double cost = costs[i].load(std::memory_order_relaxed) + euclideanDistance(tree_cur.vertices[i], v);
+                if ((parent_index == -1 || cost < parent_cost) && edgeValid(i, v)) {
+                    parent_index = i;
+                    parent_cost = cost;
+                }
+            }
+            if (parent_index == -1) {
+                continue;
+            }
+
+            // Lock-free append, published by the k-d tree link
+            int slot = next_slot.fetch_add(1, std::memory_order_relaxed);
+            if (slot >= capacity) {
+                break;
+            }
+            tree_cur.vertices[slot] = v;
+            parents[slot].store(parent_index, std::memory_order_relaxed);
+            costs[slot].store(costs[parent_index].load(std::memory_order_relaxed) + euclideanDistance(tree_cur.vertices[parent_index], v), std::memory_order_relaxed);
+            locks[slot].store(false, std::memory_order_relaxed);
+            tree_cur.index.insertConcurrent(v, slot);
+
+            // Rewire the neighbors through v, the expensive checks first, then a locked compare-and-update
+            if (!is_second_robot) {
+                for (int i : neighbors) {
+                    double edge = euclideanDistance(v, tree_cur.vertices[i]);
+                    if (costs[i].load(std::memory_order_relaxed) <= costs[slot].load(std::memory_order_relaxed) + edge || problem.isCollision(tree_cur.vertices[i], v)) {
+                        continue;
+                    }
+                    while (locks[i].exchange(true, std::memory_order_acquire)) {
+                        std::this_thread::yield();
+                    }
+                    double cost = costs[slot].load(std::memory_order_relaxed) + edge;
+                    if (costs[i].load(std::memory_order_relaxed) > cost) {
+                        parents[i].store(slot, std::memory_order_relaxed);
+                        costs[i].store(cost, std::memory_order_relaxed);
+                    }
+                    locks[i].store(false, std::memory_order_release);
+                }
+            }
+
+            if (euclideanDistance(v, goal) <= delta_s && !problem.isCollision(v, goal)) {
+                int none = -1;
+                goal_parent.compare_exchange_strong(none, slot); // The first connection wins, as in buildRRT
+                break;
+            }
+        }
+    };
+
+    // Threads 1 to num_threads - 1 get their own threads, thread 0 runs on the calling thread
+    std::vector<std::thread> threads;
+    for (int t = 1; t < num_threads; ++t) {
+        threads.emplace_back(grow, t);
+    }
+    grow(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Every slot below the final count was filled, the ones above were never handed out
+    int size = std::min(next_slot.load(), capacity);
+    tree_cur.vertices.resize(size);
+    tree_cur.index.finishConcurrent(size);
+    tree_cur.parents.resize(size);
+    tree_cur.costs.resize(size);
+    for (int i = 0; i < size; ++i) {
+        tree_cur.parents[i] = parents[i].load(std::memory_order_relaxed);
+    }
+    tree_cur.rebuildChildren(); // The concurrent rewirings left the costs of the descendants of the rewired vertices stale
+    if (goal_parent.load() != -1) {
+        addVertex(goal, goal_parent.load(), is_second_robot);
+    }
+    return size - first_slot;
+}
+
 std::tuple<std::vector<Point>, int, double> RRT::rrtPath(const Problem& problem, double delta_s, double delta_r, int max_iterations, bool use_intelligent_sampling, double p_vertex_obstacle, double p_edge_obstacle, int num_points_near_obstacles, bool is_second_robot, std::vector<Point> path_first_robot) {
-    int iterations = buildRRT(problem, delta_s, delta_r, max_iterations, use_intelligent_sampling, p_vertex_obstacle, p_edge_obstacle, num_points_near_obstacles, is_second_robot, path_first_robot); 
+    int iterations = 0;
+    PathIndex first_robot; // buildRRT indexes the path itself
+    if (is_second_robot && mode != PlannerMode::RRT_STAR) {
+        first_robot.build(path_first_robot);
+        bad_edges[1].clear(); // Blocked edges of tree2 may have been blocked by the previous path of the first robot only
+    }
+    if (mode == PlannerMode::CONNECT) {
+        iterations = buildConnect(problem, delta_s, max_iterations, use_intelligent_sampling, p_vertex_obstacle, p_edge_obstacle, num_points_near_obstacles, is_second_robot, first_robot);
+    } else if (mode == PlannerMode::INFORMED) {
+        iterations = buildInformed(problem, delta_s, delta_r, max_iterations, use_intelligent_sampling, p_vertex_obstacle, p_edge_obstacle, num_points_near_obstacles, is_second_robot, first_robot);
+    } else {
+        iterations = buildRRT(problem, delta_s, delta_r, max_iterations, use_intelligent_sampling, p_vertex_obstacle, p_edge_obstacle, num_points_near_obstacles, is_second_robot, path_first_robot);
+    }
     double path_cost = tree.costs.back(); // Cost of the path to the goal (last vertex added)
     if(is_second_robot) {
         path_cost = tree2.costs.back();
@@ -210,4 +693,19 @@ std::tuple<std::vector<Point>, std::vector<Point>> RRT::rrtPath2Robots(const Pro
     // Build the RRT for the second robot with the path of the first robot as additional obstacles
     auto [path_2, iterations_2, cost_2] = rrtPath(problem, delta_s, delta_r, max_iterations, use_intelligent_sampling, p_vertex_obstacle, p_edge_obstacle, num_points_near_obstacles, true, path_1); 
     return std::make_tuple(path_1, path_2);
-}
\ No newline at end of file
+}
+
+std::tuple<std::vector<Point>, int, double> RRT::rrtPath(const PreparedProblem& _prepared, double delta_s, double delta_r, int max_iterations, bool use_intelligent_sampling, double p_vertex_obstacle, double p_edge_obstacle, bool is_second_robot, std::vector<Point> path_first_robot) {
+    prepared = &_prepared;
+    auto result = rrtPath(_prepared.problem, delta_s, delta_r, max_iterations, use_intelligent_sampling, p_vertex_obstacle, p_edge_obstacle, _prepared.numPointsNearObstacles(), is_second_robot, path_first_robot);
+    prepared = nullptr;
+    return result;
+}
+
+std::tuple<std::vector<Point>, std::vector<Point>> RRT::rrtPath2Robots(const PreparedProblem& _prepared, double delta_s, double delta_r, int max_iterations, bool use_intelligent_sampling, double p_vertex_obstacle, double p_edge_obstacle) {
+    // Both robots sample from the same prepared point sets
+    prepared = &_prepared;
+    auto result = rrtPath2Robots(_prepared.problem, delta_s, delta_r, max_iterations, use_intelligent_sampling, p_vertex_obstacle, p_edge_obstacle, _prepared.numPointsNearObstacles());
+    prepared = nullptr;
+    return result;
+}
@@ -0,0 +1,68 @@
+#include "Random.hpp"
+
+// CONSTANTS (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC 2011)
+const uint32_t PHILOX_M0 = 0xD2511F53;
+const uint32_t PHILOX_M1 = 0xCD9E8D57;
+const uint32_t PHILOX_W0 = 0x9E3779B9;
+const uint32_t PHILOX_W1 = 0xBB67AE85;
+const int PHILOX_ROUNDS = 10;
+
+static uint64_t master_seed = 0;
+
+uint64_t masterSeed() {
+    return master_seed;
+}
+
+void setMasterSeed(uint64_t seed) {
+    master_seed = seed;
+}
+
+uint64_t streamId(StreamDomain domain, uint32_t index) {
+    return (static_cast<uint64_t>(domain) << 32) | index;
+}
+
+RandomStream::RandomStream(uint64_t seed, uint64_t _stream) : stream(_stream) {
+    key[0] = static_cast<uint32_t>(seed);
+    key[1] = static_cast<uint32_t>(seed >> 32);
+}
+
+void RandomStream::refill() {
+    // The counter holds the block index in its low half and the stream id in its high half
+    uint32_t c[4] = {static_cast<uint32_t>(counter), static_cast<uint32_t>(counter >> 32),
+                     static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32)};
+    uint32_t k0 = key[0];
+    uint32_t k1 = key[1];
+    for (int round = 0; round < PHILOX_ROUNDS; ++round) {
+        uint64_t p0 = static_cast<uint64_t>(PHILOX_M0) * c[0];
+        uint64_t p1 = static_cast<uint64_t>(PHILOX_M1) * c[2];
+        uint32_t next[4] = {static_cast<uint32_t>(p1 >> 32) ^ c[1] ^ k0, static_cast<uint32_t>(p1),
+                            static_cast<uint32_t>(p0 >> 32) ^ c[3] ^ k1, static_cast<uint32_t>(p0)};
+        c[0] = next[0];
+        c[1] = next[1];
+        c[2] = next[2];
+        c[3] = next[3];
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    block[0] = c[0];
+    block[1] = c[1];
+    block[2] = c[2];
+    block[3] = c[3];
+    counter++;
+    used = 0;
+}
+
+uint64_t RandomStream::nextU64() {
+    if (used > 2) {
+        refill();
+    }
+    uint64_t value = (static_cast<uint64_t>(block[used]) << 32) | block[used + 1];
+    used += 2;
+    return value;
+}
+
+void RandomStream::fillUniform(double* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        out[i] = uniform();
+    }
+}
@@ -0,0 +1,135 @@
+#include <vector>
+#include <utility>
+#include <cmath>
+#include <algorithm>
+
+#include "Sampler.hpp"
+
+// CONSTANTS
+const size_t BATCH_SIZE = 256; // Samples drawn ahead by next()
+
+// Radical inverse of index in the given base, the Halton coordinate of that base
+static double radicalInverse(long long index, int base) {
+    double result = 0.0, scale = 1.0 / base;
+    while (index > 0) {
+        result += (index % base) * scale;
+        index /= base;
+        scale /= base;
+    }
+    return result;
+}
+
+Sampler::Sampler(const Problem& problem, const Point& _goal, const std::vector<Point>& _obstacle_vertices, const std::vector<Point>& _edge_points)
+    : x_max(problem.x_max), y_max(problem.y_max), goal(_goal), obstacle_vertices(&_obstacle_vertices), edge_points(&_edge_points) {
+    setWeights({{SamplingStrategy::UNIFORM, 1.0}});
+}
+
+void Sampler::setWeights(const std::vector<std::pair<SamplingStrategy, double>>& weights) {
+    strategies.clear();
+    std::vector<double> w;
+    for (const auto& [strategy, weight] : weights) {
+        bool empty = (strategy == SamplingStrategy::OBSTACLE_VERTICES && obstacle_vertices->empty())
+                  || (strategy == SamplingStrategy::OBSTACLE_EDGES && edge_points->empty());
+        if (weight > 0.0 && !empty) {
+            strategies.push_back(strategy);
+            w.push_back(weight);
+        }
+    }
+    if (strategies.empty()) {
+        strategies.push_back(SamplingStrategy::UNIFORM);
+        w.push_back(1.0);
+    }
+
+    // Vose's alias method: every column holds 1/n of the probability, its own strategy up to threshold, and the
+    // excess of a heavier strategy above it
+    const int n = strategies.size();
+    double total = 0.0;
+    for (double x : w) {
+        total += x;
+    }
+    threshold.assign(n, 1.0);
+    alias.assign(n, 0);
+    std::vector<int> small, large;
+    for (int i = 0; i < n; ++i) {
+        w[i] *= n / total;
+        (w[i] < 1.0 ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty()) {
+        int s = small.back(), l = large.back();
+        small.pop_back();
+        threshold[s] = w[s];
+        alias[s] = l;
+        w[l] -= 1.0 - w[s];
+        if (w[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    for (int i : small) { // Left over by rounding, their probability is 1
+        alias[i] = i;
+    }
+    for (int i : large) {
+        alias[i] = i;
+    }
+    discardBatch();
+}
+
+Point Sampler::draw(SamplingStrategy strategy, RandomStream& stream) {
+    switch (strategy) {
+    case SamplingStrategy::HALTON:
+        if (halton_index < 0) {
+            halton_shift_x = stream.uniform();
+            halton_shift_y = stream.uniform();
+            halton_index = 0;
+        }
+        ++halton_index; // Index 0 is the corner of the map, skipped
+        return Point(std::fmod(radicalInverse(halton_index, 2) + halton_shift_x, 1.0) * x_max,
+                     std::fmod(radicalInverse(halton_index, 3) + halton_shift_y, 1.0) * y_max);
+    case SamplingStrategy::OBSTACLE_VERTICES:
+        return (*obstacle_vertices)[stream.uniformIndex(obstacle_vertices->size())];
+    case SamplingStrategy::OBSTACLE_EDGES:
+        return (*edge_points)[stream.uniformIndex(edge_points->size())];
+    case SamplingStrategy::GOAL:
+        return goal;
+    case SamplingStrategy::UNIFORM:
+    default: {
+        double x = stream.uniform() * x_max;
+        double y = stream.uniform() * y_max;
+        return Point(x, y);
+    }
+    }
+}
+
+Point Sampler::sample(RandomStream& stream) {
+    if (strategies.size() == 1) {
+        return draw(strategies[0], stream);
+    }
+    // A single uniform gives the column (integer part) and the choice within it (fractional part)
+    double u = stream.uniform() * strategies.size();
+    int column = std::min(static_cast<int>(u), static_cast<int>(strategies.size()) - 1);
+    return draw(strategies[u - column < threshold[column] ? column : alias[column]], stream);
+}
+
+void Sampler::sampleBatch(RandomStream& stream, std::vector<Point>& out) {
+    if (strategies.size() == 1 && strategies[0] == SamplingStrategy::UNIFORM) {
+        // Same values as calls to sample(), drawn in bulk
+        std::vector<double> u(2 * out.size());
+        stream.fillUniform(u.data(), u.size());
+        for (size_t i = 0; i < out.size(); ++i) {
+            out[i] = Point(u[2 * i] * x_max, u[2 * i + 1] * y_max);
+        }
+        return;
+    }
+    for (Point& p : out) {
+        p = sample(stream);
+    }
+}
+
+Point Sampler::next(RandomStream& stream) {
+    if (batch_next >= batch.size()) {
+        batch.resize(BATCH_SIZE);
+        sampleBatch(stream, batch);
+        batch_next = 0;
+    }
+    return batch[batch_next++];
+}
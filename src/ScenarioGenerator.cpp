@@ -0,0 +1,264 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "ScenarioGenerator.hpp"
+#include "Random.hpp"
+#include "utils.hpp"
+
+// CONSTANTS
+const double CLUTTER_DENSITY = 0.25; // Fraction of the map the clutter obstacles would cover without the corridors
+const int CLUTTER_MAX_ATTEMPTS = 50; // Random draws per obstacle before giving up on reaching the requested count
+const double STEPS_PER_UNIT = 1000.0; // Coordinates are rounded to 1 / STEPS_PER_UNIT, to keep the scenario files short
+
+bool parseLayout(const std::string& name, ScenarioLayout& layout) {
+    if (name == "clutter") {
+        layout = ScenarioLayout::CLUTTER;
+    } else if (name == "warehouse") {
+        layout = ScenarioLayout::WAREHOUSE;
+    } else if (name == "maze") {
+        layout = ScenarioLayout::MAZE;
+    } else if (name == "narrow") {
+        layout = ScenarioLayout::NARROW_PASSAGES;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static double snap(double v) {
+    return std::round(v * STEPS_PER_UNIT) / STEPS_PER_UNIT; // Division, so that the result is the double nearest to the decimal value
+}
+
+// Adds the rectangle, rounded and clipped to the map. Returns false if nothing is left of it.
+static bool addObstacle(Problem& problem, double x, double y, double lx, double ly) {
+    Obstacle obs;
+    obs.ll_corner = Point(std::max(0.0, snap(x)), std::max(0.0, snap(y)));
+    obs.lx = std::min(snap(lx), problem.x_max - obs.ll_corner.x);
+    obs.ly = std::min(snap(ly), problem.y_max - obs.ll_corner.y);
+    // The differences may round up, loadScenario would then reject the obstacle as exceeding the map
+    while (obs.lx > 0 && obs.ll_corner.x + obs.lx > problem.x_max) obs.lx = std::nextafter(obs.lx, 0.0);
+    while (obs.ly > 0 && obs.ll_corner.y + obs.ly > problem.y_max) obs.ly = std::nextafter(obs.ly, 0.0);
+    if (obs.lx <= 0 || obs.ly <= 0) {
+        return false;
+    }
+    problem.obstacles.push_back(obs);
+    return true;
+}
+
+static Obstacle inflate(const Obstacle& obs, double margin) {
+    Obstacle inflated = obs;
+    inflated.ll_corner = Point(obs.ll_corner.x - margin, obs.ll_corner.y - margin);
+    inflated.lx = obs.lx + 2 * margin;
+    inflated.ly = obs.ly + 2 * margin;
+    return inflated;
+}
+
+static void setEndpoints(Problem& problem, double margin) {
+    // Robot 1 crosses the map from the lower left to the upper right corner, robot 2 from the upper left to the lower right
+    problem.start1 = Point(margin, margin);
+    problem.goal1 = Point(problem.x_max - margin, problem.y_max - margin);
+    problem.start2 = Point(margin, problem.y_max - margin);
+    problem.goal2 = Point(problem.x_max - margin, margin);
+}
+
+static bool generateClutter(const ScenarioSpec& spec, Problem& problem, RandomStream& rng) {
+    double margin = std::min(2 * spec.clearance, std::min(spec.width, spec.height) / 4);
+    setEndpoints(problem, margin);
+
+    // Each robot gets a corridor through a random point of the center of the map, which no obstacle may come close to
+    std::vector<std::pair<Point, Point>> corridors;
+    for (int robot = 0; robot < 2; ++robot) {
+        Point via(rng.uniform(0.25, 0.75) * spec.width, rng.uniform(0.25, 0.75) * spec.height);
+        corridors.emplace_back(robot == 0 ? problem.start1 : problem.start2, via);
+        corridors.emplace_back(via, robot == 0 ? problem.goal1 : problem.goal2);
+    }
+
+    double side = std::sqrt(CLUTTER_DENSITY * spec.width * spec.height / spec.num_obstacles);
+    long attempts = static_cast<long>(CLUTTER_MAX_ATTEMPTS) * spec.num_obstacles;
+    while (static_cast<int>(problem.obstacles.size()) < spec.num_obstacles && attempts-- > 0) {
+        double lx = std::min(rng.uniform(0.5, 1.5) * side, spec.width);
+        double ly = std::min(rng.uniform(0.5, 1.5) * side, spec.height);
+        double x = rng.uniform(0.0, spec.width - lx);
+        double y = rng.uniform(0.0, spec.height - ly);
+        if (!addObstacle(problem, x, y, lx, ly)) {
+            continue;
+        }
+        Obstacle inflated = inflate(problem.obstacles.back(), spec.clearance);
+        for (const auto& corridor : corridors) {
+            if (pointInObstacle(corridor.first, inflated) || segmentCollisionDistance(corridor.first, corridor.second, inflated) > 0.0) {
+                problem.obstacles.pop_back();
+                break;
+            }
+        }
+    }
+    if (static_cast<int>(problem.obstacles.size()) < spec.num_obstacles) {
+        std::cerr << "Warning: Only " << problem.obstacles.size() << " obstacles fit around the corridors" << std::endl;
+    }
+    return true;
+}
+
+static bool generateWarehouse(const ScenarioSpec& spec, Problem& problem, RandomStream& rng) {
+    // Cross aisles along the four borders hold the starts and goals, shelf columns fill the rest with aisles between them
+    double margin = 3 * spec.clearance;
+    double aisle = 3 * spec.clearance;
+    double inner_width = spec.width - 2 * margin;
+    double inner_height = spec.height - 2 * margin;
+    if (inner_width <= 0 || inner_height <= 0) {
+        std::cerr << "Error: The map is too small for the clearance" << std::endl;
+        return false;
+    }
+    setEndpoints(problem, margin / 2);
+
+    // Square pallets of side p: (inner_width / (p + aisle)) columns of (inner_height / p) pallets give about num_obstacles pallets
+    double area = inner_width * inner_height / spec.num_obstacles;
+    double pallet = (-aisle + std::sqrt(aisle * aisle + 4 * area)) / 2;
+    int num_columns = std::max(1, static_cast<int>(std::round((inner_width + aisle) / (pallet + aisle))));
+    int pallets_per_column = std::max(1, static_cast<int>(std::round(inner_height / pallet)));
+    double shelf = (inner_width - (num_columns - 1) * aisle) / num_columns;
+    if (shelf <= 0) {
+        std::cerr << "Error: Too many obstacles for the map size and clearance" << std::endl;
+        return false;
+    }
+
+    for (int c = 0; c < num_columns; ++c) {
+        double x = margin + c * (shelf + aisle);
+        // Random cuts make pallets of different depths along each shelf
+        std::vector<double> cuts = {0.0, inner_height};
+        for (int p = 1; p < pallets_per_column; ++p) {
+            cuts.push_back(rng.uniform() * inner_height);
+        }
+        std::sort(cuts.begin(), cuts.end());
+        for (int p = 0; p < pallets_per_column; ++p) {
+            addObstacle(problem, x, margin + cuts[p], shelf, cuts[p + 1] - cuts[p] + 1 / STEPS_PER_UNIT); // Overlap, so that rounding leaves no gap
+        }
+    }
+    return true;
+}
+
+static bool generateMaze(const ScenarioSpec& spec, Problem& problem, RandomStream& rng) {
+    // A perfect maze on nx * ny cells keeps about one wall per cell
+    int nx = std::max(2, static_cast<int>(std::round(std::sqrt(spec.num_obstacles * spec.width / spec.height))));
+    int ny = std::max(2, static_cast<int>(std::round(double(spec.num_obstacles) / nx)));
+    double cell_w = spec.width / nx;
+    double cell_h = spec.height / ny;
+    double thickness = 0.2 * std::min(cell_w, cell_h);
+    if (std::min(cell_w, cell_h) - thickness < 2 * spec.clearance) {
+        std::cerr << "Error: Too many obstacles for the map size and clearance, the corridors of the maze would be too narrow" << std::endl;
+        return false;
+    }
+
+    // Randomized depth-first search, iterative so that millions of cells do not overflow the stack.
+    // open_east[c] and open_north[c] tell whether the walls on the right and on top of cell c were removed.
+    int num_cells = nx * ny;
+    std::vector<char> visited(num_cells, 0), open_east(num_cells, 0), open_north(num_cells, 0);
+    std::vector<int> stack = {0};
+    visited[0] = 1;
+    while (!stack.empty()) {
+        int c = stack.back();
+        int i = c % nx, j = c / nx;
+        int neighbors[4];
+        int num_neighbors = 0;
+        if (i > 0 && !visited[c - 1]) neighbors[num_neighbors++] = c - 1;
+        if (i < nx - 1 && !visited[c + 1]) neighbors[num_neighbors++] = c + 1;
+        if (j > 0 && !visited[c - nx]) neighbors[num_neighbors++] = c - nx;
+        if (j < ny - 1 && !visited[c + nx]) neighbors[num_neighbors++] = c + nx;
+        if (num_neighbors == 0) {
+            stack.pop_back();
+            continue;
+        }
+        int next = neighbors[rng.uniformIndex(num_neighbors)];
+        if (next == c + 1) open_east[c] = 1;
+        else if (next == c - 1) open_east[next] = 1;
+        else if (next == c + nx) open_north[c] = 1;
+        else open_north[next] = 1;
+        visited[next] = 1;
+        stack.push_back(next);
+    }
+
+    // Walls overlap at the corners, so that no gap is left between them
+    for (int j = 0; j < ny; ++j) {
+        for (int i = 0; i < nx; ++i) {
+            int c = j * nx + i;
+            if (i < nx - 1 && !open_east[c]) {
+                addObstacle(problem, (i + 1) * cell_w - thickness / 2, j * cell_h - thickness / 2, thickness, cell_h + thickness);
+            }
+            if (j < ny - 1 && !open_north[c]) {
+                addObstacle(problem, i * cell_w - thickness / 2, (j + 1) * cell_h - thickness / 2, cell_w + thickness, thickness);
+            }
+        }
+    }
+
+    // Starts and goals at the centers of the corner cells, all connected since the maze is perfect
+    problem.start1 = Point(cell_w / 2, cell_h / 2);
+    problem.goal1 = Point(spec.width - cell_w / 2, spec.height - cell_h / 2);
+    problem.start2 = Point(cell_w / 2, spec.height - cell_h / 2);
+    problem.goal2 = Point(spec.width - cell_w / 2, cell_h / 2);
+    return true;
+}
+
+static bool generateNarrowPassages(const ScenarioSpec& spec, Problem& problem, RandomStream& rng) {
+    // num_walls walls across the map, each made of blocks above and below a gap of width 2 * clearance
+    int num_walls = std::max(1, static_cast<int>(std::round(std::sqrt(spec.num_obstacles / 8.0))));
+    int blocks_per_wall = std::max(2, spec.num_obstacles / num_walls);
+    double thickness = spec.width / (4 * num_walls + 4);
+    double spacing = (spec.width - num_walls * thickness) / (num_walls + 1);
+    double gap = 2 * spec.clearance;
+    if (spacing < 4 * spec.clearance || spec.height < 2 * gap) {
+        std::cerr << "Error: Too many obstacles for the map size and clearance" << std::endl;
+        return false;
+    }
+    setEndpoints(problem, std::min(spacing / 2, 2 * spec.clearance));
+
+    for (int k = 0; k < num_walls; ++k) {
+        double x = spacing + k * (thickness + spacing);
+        double gap_y = rng.uniform(gap / 2, spec.height - 1.5 * gap); // Bottom of the gap
+        // The blocks are spread over the two parts of the wall in proportion to their lengths
+        double below = gap_y;
+        double above = spec.height - gap_y - gap;
+        int blocks_below = std::max(1, static_cast<int>(std::round(blocks_per_wall * below / (below + above))));
+        int blocks_above = std::max(1, blocks_per_wall - blocks_below);
+        for (int b = 0; b < blocks_below; ++b) {
+            addObstacle(problem, x, b * below / blocks_below, thickness, below / blocks_below + 1 / STEPS_PER_UNIT); // Overlap, so that rounding leaves no gap
+        }
+        for (int b = 0; b < blocks_above; ++b) {
+            addObstacle(problem, x, gap_y + gap + b * above / blocks_above, thickness, above / blocks_above + 1 / STEPS_PER_UNIT);
+        }
+    }
+    return true;
+}
+
+bool generateScenario(const ScenarioSpec& spec, Problem& problem) {
+    if (spec.width <= 0 || spec.height <= 0 || spec.num_obstacles < 1 || spec.radius < 0 || spec.clearance < 0) {
+        std::cerr << "Error: Invalid scenario specification" << std::endl;
+        return false;
+    }
+    problem = Problem();
+    problem.x_max = spec.width;
+    problem.y_max = spec.height;
+    problem.radius = spec.radius;
+    problem.obstacles.reserve(spec.num_obstacles);
+    RandomStream rng(spec.seed, streamId(StreamDomain::SCENARIO, static_cast<uint32_t>(spec.layout)));
+
+    bool generated = false;
+    switch (spec.layout) {
+        case ScenarioLayout::CLUTTER: generated = generateClutter(spec, problem, rng); break;
+        case ScenarioLayout::WAREHOUSE: generated = generateWarehouse(spec, problem, rng); break;
+        case ScenarioLayout::MAZE: generated = generateMaze(spec, problem, rng); break;
+        case ScenarioLayout::NARROW_PASSAGES: generated = generateNarrowPassages(spec, problem, rng); break;
+    }
+    if (!generated) {
+        return false;
+    }
+
+    // The layouts keep the starts and goals clear by construction, checked here in case of a degenerate specification
+    for (const Point& p : {problem.start1, problem.goal1, problem.start2, problem.goal2}) {
+        if (pointInObstacles(p, problem.obstacles)) {
+            std::cerr << "Error: A start or goal position ended up in an obstacle" << std::endl;
+            return false;
+        }
+    }
+    problem.buildIndex();
+    return true;
+}
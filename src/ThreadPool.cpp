@@ -0,0 +1,88 @@
+#include <algorithm>
+
+#include "ThreadPool.hpp"
+
+ThreadPool::ThreadPool(int _num_threads) : num_threads(std::max(1, _num_threads)) {
+    // Thread 0 is the caller of parallelFor, only the other ones are spawned
+    for (int t = 1; t < num_threads; ++t) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, t);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallelFor(int n, int grain, const std::function<void(int, int, int)>& body) {
+    if (n <= 0) {
+        return;
+    }
+    grain = std::max(1, grain);
+    if (workers.empty() || n <= grain) {
+        body(0, n, 0); // Not worth waking anyone up
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &body;
+        job_size = n;
+        job_grain = grain;
+        next_chunk.store(0);
+        active_workers = workers.size();
+        generation++;
+    }
+    wake.notify_all();
+
+    runChunks(0);
+
+    // Wait for the workers still busy on their last chunk
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return active_workers == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::workerLoop(int thread) {
+    long seen_generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen_generation; });
+            if (stopping) {
+                return;
+            }
+            seen_generation = generation;
+        }
+
+        runChunks(thread);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            active_workers--;
+            if (active_workers == 0) {
+                done.notify_one();
+            }
+        }
+    }
+}
+
+void ThreadPool::runChunks(int thread) {
+    // Chunks are handed out dynamically, so a thread slowed down by expensive iterations takes fewer of them
+    int num_chunks = (job_size + job_grain - 1) / job_grain;
+    while (true) {
+        int chunk = next_chunk.fetch_add(1);
+        if (chunk >= num_chunks) {
+            return;
+        }
+        int begin = chunk * job_grain;
+        int end = std::min(job_size, begin + job_grain);
+        (*job)(begin, end, thread);
+    }
+}
@@ -3,10 +3,21 @@
 #include <string>
 #include <random>
 #include <ctime>
+#include <thread>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
 
 #include "Problem.hpp"
 #include "PSO.hpp"
+#include "MultiSwarm.hpp"
 #include "RRT.hpp"
+#include "DistanceField.hpp"
+#include "PreparedProblem.hpp"
+#include "PathRefiner.hpp"
+#include "Random.hpp"
+#include "Batch.hpp"
+#include "utils.hpp"
 
 using namespace std;
 
@@ -18,6 +29,7 @@ const int NUM_ITERATIONS = 30000;
 const double C1 = 2.0; // cognitive coefficient
 const double C2 = 2.0; // social coefficient
 const double W = 0.75;  // inertia weight
+const int NUM_THREADS = std::max(1u, std::thread::hardware_concurrency()); // Threads evaluating and moving the particles, 1 for a sequential run
 
 // Random restart parameters
 const int RESTART_INTERVAL = 5000; // Number of iterations after which to perform a random restart
@@ -29,8 +41,14 @@ double cooling_rate = 0.99; // Between 0 and 1
 // Dimensional learning parameters
 int stagnation_threshold = 15; // Number of iterations without improvement before applying dimensional learning
 
-// Fitness function choice
-std::function<double(const std::vector<Point>&, const Problem&)> fitness_function = fitness_refined;
+// Island model parameters
+const int NUM_ISLANDS = NUM_THREADS; // Swarms running in parallel, each with NUM_PARTICLES / NUM_ISLANDS particles
+const int MIGRATION_INTERVAL = 500; // Number of iterations between two migrations
+const int NUM_MIGRANTS = 10; // Best particles sent by each island at a migration
+const MigrationTopology TOPOLOGY = MigrationTopology::RING;
+
+// Fitness function choice, Fitness or FitnessRefined (a compile-time policy, so it is inlined into the optimizers)
+const FitnessRefined fitness_function;
 
 
 /// Hyperparameters for RRT
@@ -38,6 +56,13 @@ std::function<double(const std::vector<Point>&, const Problem&)> fitness_functio
 const double RRT_DELTA_S = 100.0; // Step size for extending the tree
 const double RRT_DELTA_R = 100.0; // Radius for checking nearby vertices
 const int RRT_MAX_ITERATIONS = 10000; // Maximum number of iterations to build the RRT
+const PlannerMode RRT_MODE = PlannerMode::RRT_STAR; // RRT_STAR, CONNECT for a faster but longer first path, or INFORMED to keep improving the path
+const double RRT_TIME_BUDGET = 1.0; // Seconds the INFORMED planner spends improving its path, within RRT_MAX_ITERATIONS
+const double RRT_GOAL_BIAS = 0.0; // Probability of sampling the goal itself
+const bool RRT_QUASI_RANDOM = false; // Whether the uniform samples follow a Halton sequence, which covers the map more evenly
+const bool RRT_LAZY_COLLISION = true; // Whether RRT* checks only the candidate parents that could win, same tree with fewer collision checks
+const bool RRT_CACHE_BAD_EDGES = false; // Whether RRT* remembers the blocked edges across iterations, which pays off only with intelligent sampling
+const int RRT_NUM_THREADS = 1; // Threads growing the tree, more than 1 is faster but not reproducible from the seed
 
 // Intelligent sampling parameters
 const bool INTELLIGENT_SAMPLING = true; // Whether to use intelligent sampling  
@@ -45,6 +70,13 @@ const double P_VERTEX_OBSTACLE = 0.4; // Probability of sampling from obstacle v
 const double P_EDGE_OBSTACLE = 0.3; // Probability of sampling from points
 const int NUM_POINTS_NEAR_OBSTACLES = 1000; // Number of points to sample near obstacles for intelligent sampling
 
+
+/// Hyperparameters for the refinement of the paths found
+
+const bool REFINE_PATH = true; // Whether to polish the best path with the gradient-based refiner
+const double REFINE_CLEARANCE = 10.0; // Distance to the obstacles below which the refiner penalizes the path
+const double REFINE_WEIGHT = 10.0; // Weight of the clearance penalty against the length of the path
+
 /*
 @brief saves the given path and tree to a file and optionally visualizes them using a Python script if --plot flag is provided.
 @param argc the number of command-line arguments
@@ -140,12 +172,26 @@ void visualize_two_paths(int argc, char* argv[], vector<Point> path1, Tree* tree
     }
 }
 
+/*
+@brief polishes a path with the distance field and the gradient-based refiner, and prints the time taken
+@param problem the problem the path was found for
+@param field the distance field of problem, built once (PreparedProblem::distanceField)
+@param path the waypoints between start1 and goal1 (PSO), or the full path from start to goal (RRT)
+@param with_endpoints whether path includes its start and goal
+@return the refined path
+*/
+vector<Point> refine_path(const Problem& problem, const DistanceField& field, const vector<Point>& path, bool with_endpoints) {
+    clock_t start_time = clock();
+    PathRefiner refiner(problem, field, REFINE_CLEARANCE, REFINE_WEIGHT);
+    vector<Point> refined = with_endpoints ? refiner.refinePath(path) : refiner.refine(path, problem.start1, problem.goal1);
+    cout << "CPU time for refinement: " << double(clock() - start_time) / CLOCKS_PER_SEC << " seconds" << endl;
+    return refined;
+}
+
 // Test functions
 
 // Functions to test the PSO implementations
 int test_pso(int argc, char* argv[]){
-    srand(time(0)); // Seed the random number generator
-
     if (argc < 2 || argc > 3) {
         cerr << "Usage: " << argv[0] << " <scenario_file> [--plot]" << endl;
         return 1;
@@ -159,7 +205,7 @@ int test_pso(int argc, char* argv[]){
     }
 
     // PSO optimization
-    PSO pso(problem, NUM_PARTICLES, NUM_WAYPOINTS); // Optionally, you can specify num_particles and num_waypoints here
+    PSO pso(problem, NUM_PARTICLES, NUM_WAYPOINTS, NUM_THREADS); // Optionally, you can specify num_particles and num_waypoints here
     clock_t start_time = clock();
     auto [best_path, best_cost] = pso.optimize(problem, NUM_ITERATIONS, C1, C2, W, fitness_function); // Optimize for 10000 iterations
     clock_t end_time = clock();
@@ -180,8 +226,6 @@ int test_pso(int argc, char* argv[]){
 }
 
 int test_random_restart_pso(int argc, char* argv[]){
-    srand(time(0)); // Seed the random number generator
-
     if (argc < 2 || argc > 3) {
         cerr << "Usage: " << argv[0] << " <scenario_file> [--plot]" << endl;
         return 1;
@@ -195,7 +239,7 @@ int test_random_restart_pso(int argc, char* argv[]){
     }
 
     // PSO optimization with random restarts
-    PSO pso(problem, NUM_PARTICLES, NUM_WAYPOINTS); // Optionally, you can specify num_particles and num_waypoints here
+    PSO pso(problem, NUM_PARTICLES, NUM_WAYPOINTS, NUM_THREADS); // Optionally, you can specify num_particles and num_waypoints here
     clock_t start_time = clock();
     auto [best_path, best_cost] = pso.optimize_with_random_restart(problem, NUM_ITERATIONS, C1, C2, W, 
         RESTART_INTERVAL, fitness_function); // Optimize with random restarts
@@ -216,8 +260,6 @@ int test_random_restart_pso(int argc, char* argv[]){
 }
 
 int test_annealing_pso(int argc, char* argv[]){
-    srand(time(0)); // Seed the random number generator
-
     if (argc < 2 || argc > 3) {
         cerr << "Usage: " << argv[0] << " <scenario_file> [--plot]" << endl;
         return 1;
@@ -231,7 +273,7 @@ int test_annealing_pso(int argc, char* argv[]){
     }
 
     // PSO optimization with annealing
-    PSO pso(problem, NUM_PARTICLES, NUM_WAYPOINTS); // Optionally, you can specify num_particles and num_waypoints here
+    PSO pso(problem, NUM_PARTICLES, NUM_WAYPOINTS, NUM_THREADS); // Optionally, you can specify num_particles and num_waypoints here
     clock_t start_time = clock();
     auto [best_path, best_cost] = pso.optimize_with_annealing(problem, NUM_ITERATIONS, C1, C2, W, RESTART_INTERVAL, 
         initial_temperature, cooling_rate, fitness_function); // Optimize with annealing
@@ -252,8 +294,6 @@ int test_annealing_pso(int argc, char* argv[]){
 }
 
 int test_dimensional_learning_pso(int argc, char* argv[]){
-    srand(time(0)); // Seed the random number generator
-
     if (argc < 2 || argc > 3) {
         cerr << "Usage: " << argv[0] << " <scenario_file> [--plot]" << endl;
         return 1;
@@ -267,7 +307,7 @@ int test_dimensional_learning_pso(int argc, char* argv[]){
     }
 
     // PSO optimization with dimensional learning
-    PSO pso(problem, NUM_PARTICLES, NUM_WAYPOINTS); // Optionally, you can specify num_particles and num_waypoints here
+    PSO pso(problem, NUM_PARTICLES, NUM_WAYPOINTS, NUM_THREADS); // Optionally, you can specify num_particles and num_waypoints here
     clock_t start_time = clock();
     auto [best_path, best_cost] = pso.optimize_with_dimensional_learning(problem, NUM_ITERATIONS, C1, C2, W, 
         RESTART_INTERVAL, initial_temperature, cooling_rate, stagnation_threshold, fitness_function); // Optimize with dimensional learning
@@ -283,6 +323,55 @@ int test_dimensional_learning_pso(int argc, char* argv[]){
     cout << "Best cost: " << best_cost << endl;
     cout << "CPU time: " << cpu_time << " seconds" << endl;
 
+    if (REFINE_PATH) {
+        DistanceField field;
+        field.build(problem);
+        best_path = refine_path(problem, field, best_path, false);
+        cout << "Refined path:" << endl;
+        for (const auto& point : best_path) {
+            cout << "(" << point.x << ", " << point.y << ")" << endl;
+        }
+        cout << "Refined cost: " << fitness_function(best_path, problem) << endl;
+    }
+
+    visualize(argc, argv, best_path);
+    return 0;
+}
+
+int test_island_pso(int argc, char* argv[]){
+    if (argc < 2 || argc > 3) {
+        cerr << "Usage: " << argv[0] << " <scenario_file> [--plot]" << endl;
+        return 1;
+    }
+
+    // Load problem scenario
+    Problem problem;
+    if (!problem.loadScenario(argv[1])) {
+        cerr << "Failed to load scenario from file: " << argv[1] << endl;
+        return 1;
+    }
+
+    // PSO optimization with islands
+    MultiSwarm islands(problem, NUM_ISLANDS, std::max(1, NUM_PARTICLES / NUM_ISLANDS), NUM_WAYPOINTS);
+    auto start_time = chrono::steady_clock::now(); // Wall time, the islands run on several threads
+    auto [best_path, best_cost] = islands.optimize<FitnessRefined>(problem, NUM_ITERATIONS, C1, C2, W,
+        MIGRATION_INTERVAL, NUM_MIGRANTS, TOPOLOGY);
+    double wall_time = chrono::duration<double>(chrono::steady_clock::now() - start_time).count();
+
+    // Output results
+    cout << "Best path found:" << endl;
+    for (const auto& point : best_path) {
+        cout << "(" << point.x << ", " << point.y << ")" << endl;
+    }
+
+    cout << "Best cost: " << best_cost << " (island " << islands.best_island << ")" << endl;
+    cout << "Wall time: " << wall_time << " seconds" << endl;
+    for (size_t k = 0; k < islands.stats.size(); ++k) {
+        const IslandStats& stats = islands.stats[k];
+        cout << "Island " << k << ": best cost " << stats.best_cost << ", " << stats.migrants_accepted << " migrants accepted, "
+             << stats.wait_time << " seconds waiting" << endl;
+    }
+
     visualize(argc, argv, best_path);
     return 0;
 }
@@ -294,8 +383,6 @@ void write_path(std::ostream& out, const std::vector<Point>& path) {
 }
 
 int test_rrt(int argc, char* argv[]){
-    srand(time(0)); // Seed the random number generator
-
     if (argc < 2 || argc > 3) {
         cerr << "Usage: " << argv[0] << " <scenario_file> [--plot]" << endl;
         return 1;
@@ -308,10 +395,21 @@ int test_rrt(int argc, char* argv[]){
         return 1;
     }
 
-    // RRT
-    RRT rrt(problem); 
+    // RRT, on the problem prepared with the point sets of the intelligent sampling
+    const PreparedProblem prepared(std::move(problem), NUM_POINTS_NEAR_OBSTACLES);
+    RRT rrt(prepared.problem);
+    rrt.num_threads = RRT_NUM_THREADS;
+    rrt.mode = RRT_MODE;
+    rrt.p_goal = RRT_GOAL_BIAS;
+    rrt.quasi_random = RRT_QUASI_RANDOM;
+    rrt.lazy_collision = RRT_LAZY_COLLISION;
+    rrt.cache_bad_edges = RRT_CACHE_BAD_EDGES;
+    rrt.time_budget = RRT_TIME_BUDGET;
+    rrt.on_solution = [](const vector<Point>&, double cost, int iterations) {
+        cout << "Path of cost " << cost << " after " << iterations << " iterations" << endl;
+    };
     clock_t start_time = clock();
-    auto [best_path, iterations, path_cost] = rrt.rrtPath(problem, RRT_DELTA_S, RRT_DELTA_R, RRT_MAX_ITERATIONS, INTELLIGENT_SAMPLING, P_VERTEX_OBSTACLE, P_EDGE_OBSTACLE, NUM_POINTS_NEAR_OBSTACLES);
+    auto [best_path, iterations, path_cost] = rrt.rrtPath(prepared, RRT_DELTA_S, RRT_DELTA_R, RRT_MAX_ITERATIONS, INTELLIGENT_SAMPLING, P_VERTEX_OBSTACLE, P_EDGE_OBSTACLE);
     clock_t end_time = clock();
     double cpu_time = double(end_time - start_time) / CLOCKS_PER_SEC;
 
@@ -324,6 +422,7 @@ int test_rrt(int argc, char* argv[]){
     cout << "CPU time: " << cpu_time << " seconds" << endl;
     cout << "Iterations: " << iterations << endl;
     cout << "Path cost: " << path_cost << endl;
+    cout << "Edge cache hit rate: " << rrt.edge_cache_stats.hitRate() << " (" << rrt.edge_cache_stats.queries << " edge tests)" << endl;
 
 
 
@@ -332,8 +431,6 @@ int test_rrt(int argc, char* argv[]){
 }
 
 int test_rrt_optimized(int argc, char* argv[]){
-    srand(time(0)); // Seed the random number generator
-
     if (argc < 2 || argc > 3) {
         cerr << "Usage: " << argv[0] << " <scenario_file> [--plot]" << endl;
         return 1;
@@ -347,12 +444,20 @@ int test_rrt_optimized(int argc, char* argv[]){
     }
 
     // RRT optimization
-    RRT rrt(problem); 
+    const PreparedProblem prepared(std::move(problem), NUM_POINTS_NEAR_OBSTACLES);
+    RRT rrt(prepared.problem);
+    rrt.num_threads = RRT_NUM_THREADS;
+    rrt.mode = RRT_MODE;
+    rrt.p_goal = RRT_GOAL_BIAS;
+    rrt.quasi_random = RRT_QUASI_RANDOM;
+    rrt.lazy_collision = RRT_LAZY_COLLISION;
+    rrt.cache_bad_edges = RRT_CACHE_BAD_EDGES;
+    rrt.time_budget = RRT_TIME_BUDGET;
     clock_t start_time = clock();
-    auto [initial_path, iterations, initial_cost] = rrt.rrtPath(problem, RRT_DELTA_S, RRT_DELTA_R, RRT_MAX_ITERATIONS);
+    auto [initial_path, iterations, initial_cost] = rrt.rrtPath(prepared, RRT_DELTA_S, RRT_DELTA_R, RRT_MAX_ITERATIONS);
     
     clock_t end_build_time = clock();
-    auto [optimized_path, optimized_cost] = rrt.optimizePath(problem, initial_path);
+    auto [optimized_path, optimized_cost] = rrt.optimizePath(prepared.problem, initial_path);
     clock_t end_optimize_time = clock();
     double cpu_time_build = double(end_build_time - start_time) / CLOCKS_PER_SEC;
     double cpu_time_optimize = double(end_optimize_time - end_build_time) / CLOCKS_PER_SEC;
@@ -374,13 +479,67 @@ int test_rrt_optimized(int argc, char* argv[]){
     cout << "\nCPU time for optimization: " << cpu_time_optimize << " seconds" << endl;
     cout << "Iterations: " << iterations << endl;
 
+    if (REFINE_PATH) {
+        optimized_path = refine_path(prepared.problem, prepared.distanceField(), optimized_path, true);
+        double refined_cost = 0.0;
+        cout << "\nRefined path:" << endl;
+        for (size_t i = 0; i < optimized_path.size(); ++i) {
+            cout << "(" << optimized_path[i].x << ", " << optimized_path[i].y << ")" << endl;
+            refined_cost += i > 0 ? euclideanDistance(optimized_path[i - 1], optimized_path[i]) : 0.0;
+        }
+        cout << "Refined path cost: " << refined_cost << endl;
+    }
+
     visualize(argc, argv, optimized_path, &rrt.tree);
     return 0;
 }
 
 
+/*
+@brief removes the optional "--seed <n>" arguments from argv and sets the master seed of the random streams (the current time by default).
+@param argc the number of command-line arguments, updated
+@param argv the array of command-line arguments, updated
+@return false, after reporting it on std::cerr, if a seed is not a non-negative integer below 2^64
+*/
+bool parse_seed(int& argc, char* argv[]) {
+    uint64_t seed = time(0);
+    int kept = 1;
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--seed" && i + 1 < argc) {
+            string value = argv[++i];
+            bool valid = !value.empty() && value.find_first_not_of("0123456789") == string::npos; // stoull alone would accept a sign or trailing characters
+            if (valid) {
+                try {
+                    seed = stoull(value);
+                } catch (const out_of_range&) {
+                    valid = false;
+                }
+            }
+            if (!valid) {
+                cerr << "Error: Invalid seed " << value << endl;
+                cerr << "Usage: " << argv[0] << " [--seed <n>] <scenario_file> [--plot] | [--seed <n>] --batch <manifest>" << endl;
+                return false;
+            }
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+    setMasterSeed(seed);
+    return true;
+}
+
 int main(int argc, char* argv[]) {
+    if (!parse_seed(argc, argv)) {
+        return 1;
+    }
+    bool batch = argc == 3 && string(argv[1]) == "--batch";
+    (batch ? cerr : cout) << "Seed: " << masterSeed() << " (pass --seed " << masterSeed() << " to reproduce this run)" << endl; // Batch results may go to the standard output
+    if (batch) {
+        return runBatch(argv[2]); // Runs all the jobs of the manifest instead of the test below
+    }
     return test_dimensional_learning_pso(argc, argv);
+    //return test_island_pso(argc, argv);
     //return test_rrt(argc, argv);
     //return test_rrt_optimized(argc, argv);
     //return test_two_rrt_paths(argc, argv);
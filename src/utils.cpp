@@ -71,7 +71,8 @@ bool segmentIntersectsObstacles(const Point& p1, const Point& p2, const std::vec
 }
 
 // Computes the analytical distance that the line segment from p1 to p2 travels into the obstacle obs using the Liang-Barsky algorithm
-double segmentCollisionDistance(const Point& p1, const Point& p2, const Obstacle& obs) {
+// The clipping starts from [t_start, t_end] instead of [0, 1] when only a piece of the segment is of interest
+double segmentCollisionDistance(const Point& p1, const Point& p2, const Obstacle& obs, double t_start, double t_end) {
     const double xmin = obs.ll_corner.x;
     const double xmax = obs.ll_corner.x + obs.lx;
     const double ymin = obs.ll_corner.y;
@@ -86,8 +87,8 @@ double segmentCollisionDistance(const Point& p1, const Point& p2, const Obstacle
         return 0.0;
     }
 
-    double t0 = 0.0;
-    double t1 = 1.0;
+    double t0 = t_start;
+    double t1 = t_end;
 
     auto clip = [&](double p, double q) -> bool {
         if (std::abs(p) <= eps) {
@@ -129,13 +130,13 @@ double segmentCollisionDistance(const Point& p1, const Point& p2, const Obstacle
         return 0.0;
     }
 
-    const double t_start = std::max(0.0, t0);
-    const double t_end = std::min(1.0, t1);
-    if (t_end < t_start) {
+    const double t_in = std::max(0.0, t0);
+    const double t_out = std::min(1.0, t1);
+    if (t_out < t_in) {
         return 0.0;
     }
 
-    return (t_end - t_start) * seg_len;
+    return (t_out - t_in) * seg_len;
 }
 
 double segmentCollisionDistance(const Point& p1, const Point& p2, const std::vector<Obstacle>& obstacles) {
@@ -0,0 +1,34 @@
+/*
+Converts a scenario between the text and the binary formats read by Problem::loadScenario.
+
+Usage:
+    ./convert_scenario <input_file> <output_file> [--text|--binary]
+
+The input format is detected. Without --text or --binary, the output is written in the other format.
+*/
+
+#include <iostream>
+#include <string>
+
+#include "Problem.hpp"
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    if (argc < 3 || argc > 4 || (argc == 4 && string(argv[3]) != "--text" && string(argv[3]) != "--binary")) {
+        cerr << "Usage: " << argv[0] << " <input_file> <output_file> [--text|--binary]" << endl;
+        return 1;
+    }
+    ScenarioFormat format = isBinaryScenario(argv[1]) ? ScenarioFormat::TEXT : ScenarioFormat::BINARY;
+    if (argc == 4) {
+        format = string(argv[3]) == "--binary" ? ScenarioFormat::BINARY : ScenarioFormat::TEXT;
+    }
+
+    Problem problem;
+    if (!problem.loadScenario(argv[1]) || !problem.saveScenario(argv[2], format)) {
+        return 1;
+    }
+    cout << "Wrote " << problem.obstacles.size() << " obstacles to " << argv[2]
+         << (format == ScenarioFormat::BINARY ? " (binary)" : " (text)") << endl;
+    return 0;
+}